@@ -18,6 +18,7 @@ public class PDFImporter : ModuleRules
                 "Engine",
                 "InputCore",
                 "SlateCore",
+                "DeveloperSettings",
 				// ... add other public dependencies that you statically link with here ...
 			}
 			);
@@ -37,24 +38,45 @@ public class PDFImporter : ModuleRules
 
         string GhostscriptPath = Path.Combine(ModuleDirectory, "..", "..", "ThirdParty");
         string Platform = string.Empty;
+        string LibraryName = string.Empty;
 	
         if(Target.Platform == UnrealTargetPlatform.Win64)
         {
             Platform = "Win64";
+            LibraryName = "gsdll.dll";
         }
         else if(Target.Platform == UnrealTargetPlatform.Win32)
         {
             Platform = "Win32";
+            LibraryName = "gsdll.dll";
+        }
+        else if(Target.Platform == UnrealTargetPlatform.Linux)
+        {
+            Platform = "Linux";
+            LibraryName = "libgs.so";
         }
         else
         {
             throw new Exception(string.Format("Unsupported platform {0}", Target.Platform.ToString()));
         }
 	
-        GhostscriptPath = Path.Combine(GhostscriptPath, Platform, "gsdll.dll");
+        // PDFium is an optional backend, so it is only staged when bundled
+        string PDFiumPath = Path.Combine(ModuleDirectory, "..", "..", "ThirdParty", Platform, (Target.Platform == UnrealTargetPlatform.Linux) ? "libpdfium.so" : "pdfium.dll");
+        if(File.Exists(PDFiumPath))
+        {
+            RuntimeDependencies.Add(PDFiumPath);
+        }
+
+        GhostscriptPath = Path.Combine(GhostscriptPath, Platform, LibraryName);
 
         if(!File.Exists(GhostscriptPath))
         {
+            // On Linux the libgs.so installed on the system is used when none is bundled
+            if(Target.Platform == UnrealTargetPlatform.Linux)
+            {
+                return;
+            }
+
             throw new Exception(string.Format("File not found {0}", GhostscriptPath));
         }
 
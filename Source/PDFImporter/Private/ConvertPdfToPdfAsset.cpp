@@ -1,17 +1,17 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "ConvertPdfToPdfAsset.h"
-#include "GhostscriptCore.h"
+#include "PDFConversionScheduler.h"
+#include "PDFImporter.h"
 #include "PDF.h"
-#include "AsyncExecTask.h"
 #include "Misc/Paths.h"
 
 UConvertPdfToPdfAsset::UConvertPdfToPdfAsset(const FObjectInitializer& ObjectInitializer)
-	: Super(ObjectInitializer), WorldContextObject(nullptr), bIsActive(false), 
-	  PDFFilePath(""), Dpi(0), FirstPage(0), LastPage(0)
+	: Super(ObjectInitializer), WorldContextObject(nullptr), bIsActive(false), RequestHandle(0),
+	  PDFFilePath(""), Dpi(0), FirstPage(0), LastPage(0), RenderMode(EPDFRenderMode::InMemory), Backend(EPDFRasterizerBackend::Ghostscript), bExtractText(false), PreviewDpi(0), Priority(EPDFConversionPriority::Interactive)
 {
 	FPDFImporterModule& PDFImporterModule = FModuleManager::LoadModuleChecked<FPDFImporterModule>(FName("PDFImporter"));
-	GhostscriptCore = PDFImporterModule.GetGhostscriptCore();
+	ConversionScheduler = PDFImporterModule.GetConversionScheduler();
 }
 
 UConvertPdfToPdfAsset* UConvertPdfToPdfAsset::ConvertPdfToPdfAsset(
@@ -19,7 +19,12 @@ UConvertPdfToPdfAsset* UConvertPdfToPdfAsset::ConvertPdfToPdfAsset(
 	const FString& PDF_FilePath, 
 	int Dpi,
 	int FirstPage,
-	int LastPage
+	int LastPage,
+	EPDFRenderMode RenderMode,
+	EPDFRasterizerBackend Backend,
+	bool bExtractText,
+	int PreviewDpi,
+	EPDFConversionPriority Priority
 ){
 	UConvertPdfToPdfAsset* Node = NewObject<UConvertPdfToPdfAsset>();
 	Node->WorldContextObject = WorldContextObject;
@@ -27,6 +32,11 @@ UConvertPdfToPdfAsset* UConvertPdfToPdfAsset::ConvertPdfToPdfAsset(
 	Node->Dpi = Dpi;
 	Node->FirstPage = FirstPage;
 	Node->LastPage = LastPage;
+	Node->RenderMode = RenderMode;
+	Node->Backend = Backend;
+	Node->bExtractText = bExtractText;
+	Node->PreviewDpi = PreviewDpi;
+	Node->Priority = Priority;
 	return Node;
 }
 
@@ -44,10 +54,38 @@ void UConvertPdfToPdfAsset::Activate()
 		return;
 	}
 	
-	// ϊJn
-	auto ConvertTask = new FAutoDeleteAsyncTask<FAsyncExecTask>([this]() 
+	bIsActive = true;
+	ReadyPages.Empty();
+
+	FPDFConversionRequest Request;
+	Request.InputPath = PDFFilePath;
+	Request.Dpi = Dpi;
+	Request.FirstPage = FirstPage;
+	Request.LastPage = LastPage;
+	Request.RenderMode = RenderMode;
+	Request.Backend = Backend;
+	Request.bExtractText = bExtractText;
+	Request.PreviewDpi = PreviewDpi;
+
+	// ϊ̓XPW[[ɔCAʂ̓Q[XbhŎ󂯎
+	FPDFConversionCallbacks Callbacks;
+	Callbacks.OnPageLoaded = [this](int PageIndex, UTexture2D* Page)
+	{
+		// 2ڂ̒ʒm̓vr[ŏIIȉ𑜓xɍւ
+		if (ReadyPages.Contains(PageIndex))
+		{
+			OnPageRefined.Broadcast(PageIndex, Page);
+		}
+		else
+		{
+			ReadyPages.Add(PageIndex);
+			OnPageReady.Broadcast(PageIndex, Page);
+		}
+	};
+	Callbacks.OnFinished = [this](UPDF* PDFAsset)
 	{
-		UPDF* PDFAsset = GhostscriptCore->ConvertPdfToPdfAsset(PDFFilePath, Dpi, FirstPage, LastPage);
+		bIsActive = false;
+		RequestHandle = 0;
 		if (PDFAsset != nullptr)
 		{
 			Completed.Broadcast(PDFAsset);
@@ -56,7 +94,23 @@ void UConvertPdfToPdfAsset::Activate()
 		{
 			Failed.Broadcast();
 		}
-	});
+	};
 
-	ConvertTask->StartBackgroundTask();
+	RequestHandle = ConversionScheduler->Schedule(Request, Priority, Callbacks, Token);
+}
+
+void UConvertPdfToPdfAsset::Cancel()
+{
+	// ϊ҂Ă鑼̃m[h΁Aϊ̂͑
+	if (RequestHandle != 0)
+	{
+		ConversionScheduler->Cancel(RequestHandle);
+	}
+}
+
+void UConvertPdfToPdfAsset::GetProgress(int& PagesDone, int& PagesTotal, int64& BytesProcessed) const
+{
+	PagesDone = Token.IsValid() ? Token->GetNumPagesDone() : 0;
+	PagesTotal = Token.IsValid() ? Token->GetNumPagesTotal() : 0;
+	BytesProcessed = Token.IsValid() ? Token->GetBytesProcessed() : 0;
 }
@@ -1,127 +1,440 @@
 #include "GhostscriptCore.h"
+#include "GhostscriptRasterizer.h"
+#include "PDFiumRasterizer.h"
+#include "PDFRenderCache.h"
+#include "PDFImporterSettings.h"
 #include "PDF.h"
 #include "Engine/Texture2D.h"
 #include "Misc/Paths.h"
 #include "Misc/FileHelper.h"
 #include "GenericPlatform/GenericPlatformProcess.h"
 #include "HAL/FileManager.h"
+#include "Async/Async.h"
+#include "Containers/Queue.h"
+#include "HAL/Event.h"
+#include "Misc/ScopeLock.h"
+#include "PDFConversionToken.h"
 #include "AssetRegistryModule.h"
-#include "IImageWrapperModule.h"
-#include "IImageWrapper.h"
+#include "PageDecoderPool.h"
+#include "RawPageFile.h"
+#include "PDFTextureUploader.h"
+#include "PageCompressor.h"
+#include "PageMipGenerator.h"
+#include "Async/ParallelFor.h"
 #include "IPluginManager.h"
+#include "Hash/CityHash.h"
+#include "Misc/App.h"
+#include "Misc/Guid.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/GarbageCollection.h"
+#include "Misc/Optional.h"
+#include "Misc/QueuedThreadPool.h"
+#include "HAL/PlatformMisc.h"
 
-#include "AllowWindowsPlatformTypes.h"
-#include <Windows.h>
-#include "HideWindowsPlatformTypes.h"
+namespace
+{
+	// o͌`ɍ킹Ghostscript̃foCXƊgq擾
+	void GetPageFileFormat(EPDFRenderMode RenderMode, FString& OutDevice, FString& OutExtension)
+	{
+		switch (RenderMode)
+		{
+		case EPDFRenderMode::Ppm:
+			OutDevice = TEXT("ppmraw");
+			OutExtension = TEXT("ppm");
+			break;
+		case EPDFRenderMode::Pgm:
+			OutDevice = TEXT("pgmraw");
+			OutExtension = TEXT("pgm");
+			break;
+		case EPDFRenderMode::Bmp:
+			OutDevice = TEXT("bmp16m");
+			OutExtension = TEXT("bmp");
+			break;
+		default:
+			OutDevice = TEXT("jpeg");
+			OutExtension = TEXT("jpg");
+			break;
+		}
+	}
+}
+
+namespace
+{
+	// ÖُIȂǂŎcƂ݂ȂƃfBNǧÂ
+	const FTimespan StaleWorkspaceAge = FTimespan::FromDays(1.0);
+
+	// `悷Xbh̃X^bN̑傫iC^v^ĂяõXbhœ̂ő傫߂ɂj
+	const uint32 RenderThreadStackSize = 1024 * 1024;
+
+	// ƃfBNgufBNg߂
+	FString GetWorkspaceRoot(const UPDFImporterSettings* Settings)
+	{
+		if (Settings->bUseRamWorkspace)
+		{
+#if PLATFORM_LINUX
+			// tmpfsɃvWFNgƂ̃fBNg
+			const FString SharedMemoryPath = TEXT("/dev/shm");
+			if (IFileManager::Get().DirectoryExists(*SharedMemoryPath))
+			{
+				return FPaths::Combine(SharedMemoryPath, FString(TEXT("PDFImporter-")) + FApp::GetProjectName());
+			}
+#endif
+			UE_LOG(PDFImporter, Warning, TEXT("No RAM-backed file system is available for the workspace, so the disk is used instead"));
+		}
+
+		const FString WorkspaceRoot = Settings->WorkspaceDirectory.IsEmpty() ? FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ConvertTemp")) : Settings->WorkspaceDirectory;
+		return FPaths::ConvertRelativePathToFull(WorkspaceRoot);
+	}
+}
 
 const FString FGhostscriptCore::PagesDirectoryPath = FPaths::ConvertRelativePathToFull(FPaths::Combine(IPluginManager::Get().FindPlugin(TEXT("PDFImporter"))->GetBaseDir(), TEXT("Content")));
 
 FGhostscriptCore::FGhostscriptCore()
 {
-	// dllt@C̃pX擾
-	FString GhostscriptDllPath = FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectPluginsDir(), TEXT("PDFImporter"), TEXT("ThirdParty")));
-#ifdef _WIN64
-	GhostscriptDllPath = FPaths::Combine(GhostscriptDllPath, TEXT("Win64"));
-#elif _WIN32
-	GhostscriptDllPath = FPaths::Combine(GhostscriptDllPath, TEXT("Win32"));
-#endif
-	GhostscriptDllPath = FPaths::Combine(GhostscriptDllPath, TEXT("gsdll.dll"));
+	// s̃vbgtH[pGhostscript[h
+	Ghostscript = FGhostscriptRasterizer::Create();
+
+	// PDFiumCXg[ĂΎg悤ɂ
+	PDFium = FPDFiumRasterizer::Create();
 
-	// W[[h
-	GhostscriptModule = FPlatformProcess::GetDllHandle(*GhostscriptDllPath);
-	if (GhostscriptModule == nullptr)
+	// ϊς݂̃y[WėpLbV
+	const UPDFImporterSettings* Settings = GetDefault<UPDFImporterSettings>();
+	if (Settings->bUseRenderCache)
 	{
-		UE_LOG(PDFImporter, Fatal, TEXT("Failed to load Ghostscript module"));
+		const FString CacheDirectory = Settings->RenderCacheDirectory.IsEmpty() ? FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("PDFRenderCache")) : Settings->RenderCacheDirectory;
+		RenderCache = MakeShared<FPDFRenderCache>(CacheDirectory, (int64)Settings->RenderCacheMegabytes * 1024 * 1024);
 	}
 
-	// ֐|C^擾
-	CreateInstance = (CreateAPIInstance)FPlatformProcess::GetDllExport(GhostscriptModule, TEXT("gsapi_new_instance"));
-	DeleteInstance = (DeleteAPIInstance)FPlatformProcess::GetDllExport(GhostscriptModule, TEXT("gsapi_delete_instance"));
-	Init = (InitAPI)FPlatformProcess::GetDllExport(GhostscriptModule, TEXT("gsapi_init_with_args"));
-	Exit = (ExitAPI)FPlatformProcess::GetDllExport(GhostscriptModule, TEXT("gsapi_exit"));
-	if (CreateInstance == nullptr || DeleteInstance == nullptr || Init == nullptr || Exit == nullptr)
+	DecoderPool = MakeShared<FPageDecoderPool>();
+
+	// `̓y[W܂ŃXbhL̂ŁAGW̋L̃Xbhv[Ƃ͕ʂ̃Xbhōs
+	// ɓϊƂɁAvr[Ɩ{Ԃ̕`2󂯎Ă悤ɂ
+	const int MaxConcurrentConversions = (Settings->MaxConcurrentConversions > 0) ? Settings->MaxConcurrentConversions : FMath::Max(FPlatformMisc::NumberOfCores() / 2, 1);
+	RenderThreadPool = FQueuedThreadPool::Allocate();
+	RenderThreadPool->Create(MaxConcurrentConversions * 2, RenderThreadStackSize, TPri_BelowNormal);
+
+	TextureUploader = MakeShared<FPDFTextureUploader>((int64)Settings->UploadMegabytesPerFrame * 1024 * 1024);
+	bCompressRuntimePages = Settings->bCompressRuntimePages;
+	bGeneratePageMips = Settings->bGeneratePageMips;
+
+	// zeNX`̓vWFNgŗLɂȂĂꍇg
+	static const auto CVarVirtualTextures = IConsoleManager::Get().FindTConsoleVariableDataInt(TEXT("r.VirtualTextures"));
+	bImportAsVirtualTextures = Settings->bImportAsVirtualTextures;
+	if (bImportAsVirtualTextures && (CVarVirtualTextures == nullptr || CVarVirtualTextures->GetValueOnAnyThread() == 0))
 	{
-		UE_LOG(PDFImporter, Fatal, TEXT("Failed to get Ghostscript function pointer"));
+		UE_LOG(PDFImporter, Warning, TEXT("Pages are imported as regular textures because virtual texture support is disabled in the project settings"));
+		bImportAsVirtualTextures = false;
 	}
 
-	IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
-	ImageWrapper = ImageWrapperModule.CreateImageWrapper(EImageFormat::JPEG);
-
-	UE_LOG(PDFImporter, Log, TEXT("Ghostscrip dll loaded"));
+	// ϊƂ̍ƃfBNg̒uꏊ
+	// ̃vZXgĂ\̂ŁA\ɌÂ̂폜
+	WorkspaceRoot = GetWorkspaceRoot(Settings);
+	IFileManager& FileManager = IFileManager::Get();
+	TArray<FString> Workspaces;
+	FileManager.FindFiles(Workspaces, *FPaths::Combine(WorkspaceRoot, TEXT("*")), false, true);
+	for (const FString& Workspace : Workspaces)
+	{
+		const FString WorkspacePath = FPaths::Combine(WorkspaceRoot, Workspace);
+		if (FDateTime::UtcNow() - FileManager.GetTimeStamp(*WorkspacePath) > StaleWorkspaceAge)
+		{
+			FileManager.DeleteDirectory(*WorkspacePath, false, true);
+		}
+	}
 }
 
 FGhostscriptCore::~FGhostscriptCore()
 {
-	FPlatformProcess::FreeDllHandle(GhostscriptModule);
-	UE_LOG(PDFImporter, Log, TEXT("Ghostscript dll unloaded"));
+	RenderThreadPool->Destroy();
+	delete RenderThreadPool;
+	RenderThreadPool = nullptr;
+
+	RenderCache.Reset();
+	PDFium.Reset();
+	Ghostscript.Reset();
 }
 
-UPDF* FGhostscriptCore::ConvertPdfToPdfAsset(const FString& InputPath, int Dpi, int FirstPage, int LastPage, bool bIsImportIntoEditor)
+void FGhostscriptCore::StopTextureUploads()
+{
+	TextureUploader->Stop();
+}
+
+IPDFRasterizer* FGhostscriptCore::GetRasterizer(EPDFRasterizerBackend Backend) const
+{
+	if (Backend == EPDFRasterizerBackend::PDFium)
+	{
+		if (PDFium.IsValid())
+		{
+			return PDFium.Get();
+		}
+
+		UE_LOG(PDFImporter, Warning, TEXT("PDFium is not available, falling back to Ghostscript"));
+	}
+
+	return Ghostscript.Get();
+}
+
+bool FGhostscriptCore::ProbePdf(const FString& InputPath, FPDFDocumentInfo& OutInfo)
+{
+	// PDF邩mF
+	if (!IFileManager::Get().FileExists(*InputPath))
+	{
+		UE_LOG(PDFImporter, Error, TEXT("File not found : %s"), *InputPath);
+		return false;
+	}
+
+	if (!Ghostscript.IsValid() || !Ghostscript->ProbePdf(InputPath, OutInfo))
+	{
+		UE_LOG(PDFImporter, Warning, TEXT("Failed to read the page tree of %s"), *InputPath);
+		return false;
+	}
+
+	return true;
+}
+
+bool FGhostscriptCore::ExtractText(const FString& InputPath, int FirstPage, int LastPage, FPDFTextIndex& OutIndex, FPDFConversionToken* Token)
+{
+	if (!Ghostscript.IsValid())
+	{
+		UE_LOG(PDFImporter, Error, TEXT("Ghostscript is not available"));
+		return false;
+	}
+
+	TArray<FPDFTextIndex::FWord> Words;
+	if (!Ghostscript->ExtractText(InputPath, FirstPage, LastPage, Words, Token))
+	{
+		UE_LOG(PDFImporter, Warning, TEXT("Failed to extract text from %s"), *InputPath);
+		return false;
+	}
+
+	OutIndex.Build(Words);
+	return true;
+}
+
+UPDF* FGhostscriptCore::ConvertPdfToPdfAsset(const FString& InputPath, int Dpi, int FirstPage, int LastPage, EPDFRenderMode RenderMode, EPDFRasterizerBackend Backend, bool bIsImportIntoEditor, const FPDFPageLoadedCallback& OnPageLoaded, FPDFConversionToken* Token, int PreviewDpi, const FPDFReusablePages* ReusablePages)
 {
-	IFileManager& FileManager = IFileManager::Get();
-	
 	// PDF邩mF
-	if (!FileManager.FileExists(*InputPath))
+	if (!IFileManager::Get().FileExists(*InputPath))
 	{
 		UE_LOG(PDFImporter, Error, TEXT("File not found : %s"), *InputPath);
 		return nullptr;
 	}
 
-	// Ɨp̃fBNg쐬
-	FString TempDirPath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ConvertTemp"));
-	TempDirPath = FPaths::ConvertRelativePathToFull(TempDirPath);
-	if (FileManager.DirectoryExists(*TempDirPath))
+	// ePDF𓯂ݒŕϊς݂ȂLbVǂݍ
+	const EPDFRasterizerBackend UsedBackend = (RenderMode == EPDFRenderMode::InMemory && PDFium.IsValid() && GetRasterizer(Backend) == PDFium.Get()) ? EPDFRasterizerBackend::PDFium : EPDFRasterizerBackend::Ghostscript;
+	const FString CacheKey = RenderCache.IsValid() ? FPDFRenderCache::MakeKey(InputPath, Dpi, FirstPage, LastPage, RenderMode, UsedBackend) : FString();
+
+	FString CachedEntryPath;
+	FString CachedExtension;
+	int NumCachedPages = 0;
+	if (!CacheKey.IsEmpty() && RenderCache->Find(CacheKey, CachedEntryPath, CachedExtension, NumCachedPages))
 	{
-		FileManager.DeleteDirectory(*TempDirPath);
+		UE_LOG(PDFImporter, Log, TEXT("Loading %d pages of %s from the render cache (%s)"), NumCachedPages, *InputPath, *CachedEntryPath);
+	}
+	else
+	{
+		CachedEntryPath.Empty();
 	}
-	FileManager.MakeDirectory(*TempDirPath);
-	UE_LOG(PDFImporter, Log, TEXT("A working directory has been created (%s)"), *TempDirPath);
 
-	// GhostscriptpPDFjpg摜쐬
-	FString OutputPath = FPaths::Combine(TempDirPath, FPaths::GetBaseFilename(InputPath) + TEXT("%010d.jpg"));
-	TArray<UTexture2D*> Buffer; 
-	UPDF* PDFAsset = nullptr;
+	// i\̂߂ɑy[W𒲂ׂ
+	if (Token != nullptr)
+	{
+		int NumPagesTotal = LastPage - FirstPage + 1;
+		if (!CachedEntryPath.IsEmpty())
+		{
+			NumPagesTotal = NumCachedPages;
+		}
+		else if (FirstPage <= 0 || LastPage <= 0 || FirstPage > LastPage)
+		{
+			IPDFRasterizer* Rasterizer = (RenderMode == EPDFRenderMode::InMemory) ? GetRasterizer(Backend) : Ghostscript.Get();
+			NumPagesTotal = (Rasterizer != nullptr) ? Rasterizer->GetPageCount(InputPath) : 0;
+		}
+		Token->SetNumPagesTotal(FMath::Max(NumPagesTotal, 0));
+		Token->NotifyProgress();
+	}
 
-	if (ConvertPdfToJpeg(InputPath, OutputPath, Dpi, FirstPage, LastPage))
+	// ăC|[gŎg񂵂eNX`͌₩OĂ
+	FPDFReusablePages RemainingPages;
+	if (ReusablePages != nullptr && bIsImportIntoEditor)
 	{
-		// 摜̃t@CpX擾
-		TArray<FString> PageNames;
-		IFileManager::Get().FindFiles(PageNames, *TempDirPath, L"jpg");
-		
-		// 쐬jpg摜ǂݍ
-		UTexture2D* TextureTemp;
-		for (const FString& PageName : PageNames)
+		RemainingPages = *ReusablePages;
+	}
+
+	// ey[W̃eNX`쐬
+	TArray<UTexture2D*> Buffer;
+	TArray<uint64> Fingerprints;
+	bool bResult = false;
+	if (!CachedEntryPath.IsEmpty())
+	{
+		bResult = LoadPagesFromDirectory(CachedEntryPath, CachedExtension, FPaths::GetBaseFilename(InputPath), bIsImportIntoEditor, OnPageLoaded, Token, &RemainingPages, Buffer, Fingerprints);
+		RenderCache->ReleaseEntry(CacheKey);
+
+		// y[W̃t@C͌ɑĂ̂ŁAȂ͓̂ǂݍ߂Ȃy[W
+		// ʒmς݂̃y[W͎Ȃ̂ŁA`ɎsꍇƓǂݍ߂ʂɂ
+		if (bResult && Buffer.Num() != NumCachedPages)
 		{
-			bool bResult = false;
-			if (bIsImportIntoEditor)
+			UE_LOG(PDFImporter, Warning, TEXT("Only %d of the %d pages in the render cache entry have been loaded (%s)"), Buffer.Num(), NumCachedPages, *CachedEntryPath);
+		}
+	}
+	else
+	{
+		// `悵y[W̓LbVɂ
+		FString Device;
+		FString Extension;
+		GetPageFileFormat(RenderMode, Device, Extension);
+		const FString CacheStagingPath = CacheKey.IsEmpty() ? FString() : RenderCache->BeginEntry(CacheKey);
+
+		// r܂ł`łȂʂ̓LbVɎcȂ
+		bool bIsComplete = true;
+
+		switch (RenderMode)
+		{
+		case EPDFRenderMode::InMemory:
+			bResult = LoadPagesFromBitmap(InputPath, Dpi, FirstPage, LastPage, Backend, bIsImportIntoEditor, OnPageLoaded, Token, CacheStagingPath, PreviewDpi, &RemainingPages, Buffer, Fingerprints, bIsComplete);
+			Extension = TEXT("bmp");
+			break;
+		case EPDFRenderMode::Jpeg:
+		case EPDFRenderMode::Ppm:
+		case EPDFRenderMode::Pgm:
+		case EPDFRenderMode::Bmp:
+			bResult = LoadPagesFromFile(InputPath, Dpi, FirstPage, LastPage, RenderMode, bIsImportIntoEditor, OnPageLoaded, Token, CacheStagingPath, &RemainingPages, Buffer, Fingerprints);
+			break;
+		}
+
+		if (!CacheStagingPath.IsEmpty())
+		{
+			if (bResult && bIsComplete && Buffer.Num() > 0 && (Token == nullptr || !Token->IsCanceled()))
 			{
-#if WITH_EDITORONLY_DATA
-				bResult = CreateTextureAssetFromFile(FPaths::Combine(TempDirPath, PageName), TextureTemp);
-#endif
+				RenderCache->CommitEntry(CacheKey, CacheStagingPath, Extension, Buffer.Num());
 			}
 			else
 			{
-				bResult = LoadTexture2DFromFile(FPaths::Combine(TempDirPath, PageName), TextureTemp);
-			}
-			
-			if (bResult)
-			{
-				Buffer.Add(TextureTemp);
+				RenderCache->AbandonEntry(CacheStagingPath);
 			}
 		}
+	}
+
+	if (!bResult || (Token != nullptr && Token->IsCanceled()))
+	{
+		return nullptr;
+	}
+
+#if WITH_EDITOR
+	// sĈkĂy[W҂Ă烊\[X쐬
+	if (bIsImportIntoEditor)
+	{
+		for (UTexture2D* Page : Buffer)
+		{
+			Page->FinishCachePlatformData();
+			Page->UpdateResource();
+		}
+	}
+#endif
+
+	// PDFAZbg쐬
+	// Q[XbhȊOł̓Kx[WRNV~߂čAĂяo󂯎܂Ńg[Nŕێ
+	UPDF* PDFAsset = nullptr;
+	{
+		TOptional<FGCScopeGuard> GCGuard;
+		if (!IsInGameThread())
+		{
+			GCGuard.Emplace();
+		}
 
-		// PDFAZbg쐬
 		PDFAsset = NewObject<UPDF>();
+		if (Token != nullptr)
+		{
+			Token->KeepAlive(PDFAsset);
+		}
+	}
+
+	if (FirstPage <= 0 || LastPage <= 0 || FirstPage > LastPage)
+	{
+		FirstPage = 1;
+		LastPage = Buffer.Num();
+	}
+
+	PDFAsset->PageRange = FPageRange(FirstPage, LastPage);
+	PDFAsset->Dpi = Dpi;
+	PDFAsset->Pages = Buffer;
+	PDFAsset->PageFingerprints = Fingerprints;
+	PDFAsset->UpdatePageSizes();
+
+	return PDFAsset;
+}
+
+FString FGhostscriptCore::CreateWorkspace() const
+{
+	// ɓϊƂԂȂ悤GUIDŖOt
+	const FString WorkspacePath = FPaths::Combine(WorkspaceRoot, FGuid::NewGuid().ToString());
+	if (!IFileManager::Get().MakeDirectory(*WorkspacePath, true))
+	{
+		UE_LOG(PDFImporter, Error, TEXT("Failed to create a working directory (%s)"), *WorkspacePath);
+		return FString();
+	}
+
+	UE_LOG(PDFImporter, Log, TEXT("A working directory has been created (%s)"), *WorkspacePath);
+	return WorkspacePath;
+}
+
+bool FGhostscriptCore::LoadPagesFromFile(const FString& InputPath, int Dpi, int FirstPage, int LastPage, EPDFRenderMode RenderMode, bool bIsImportIntoEditor, const FPDFPageLoadedCallback& OnPageLoaded, FPDFConversionToken* Token, const FString& CacheStagingPath, FPDFReusablePages* ReusablePages, TArray<UTexture2D*>& OutPages, TArray<uint64>& OutFingerprints)
+{
+	IFileManager& FileManager = IFileManager::Get();
+
+	if (!Ghostscript.IsValid())
+	{
+		UE_LOG(PDFImporter, Error, TEXT("Ghostscript is not available"));
+		return false;
+	}
+
+	// ̕ϊgƗp̃fBNg쐬
+	const FString TempDirPath = CreateWorkspace();
+	if (TempDirPath.IsEmpty())
+	{
+		return false;
+	}
+
+	// o͌`ɍ킹foCXƊgq
+	FString Device;
+	FString Extension;
+	GetPageFileFormat(RenderMode, Device, Extension);
 
-		if (FirstPage <= 0 || LastPage <= 0 || FirstPage > LastPage)
+	// GhostscriptpPDF摜쐬
+	FString OutputPath = FPaths::Combine(TempDirPath, FPaths::GetBaseFilename(InputPath) + TEXT("%010d.") + Extension);
+	// ϊiʒmł悤ɃobNOEhŎs
+	TFuture<bool> ConvertResult = AsyncPool(*RenderThreadPool, [&]()
+	{
+		return Ghostscript->ConvertPdfToImageFiles(InputPath, OutputPath, Device, Dpi, FirstPage, LastPage, Token);
+	});
+	while (!ConvertResult.WaitFor(FTimespan::FromMilliseconds(100)))
+	{
+		if (Token != nullptr)
 		{
-			FirstPage = 1;
-			LastPage = Buffer.Num();
+			Token->NotifyProgress();
 		}
+	}
+	bool bIsSucceeded = ConvertResult.Get();
+
+	if (bIsSucceeded)
+	{
+		// 쐬摜ǂݍ
+		bIsSucceeded = LoadPagesFromDirectory(TempDirPath, Extension, FPaths::GetBaseFilename(InputPath), bIsImportIntoEditor, OnPageLoaded, Token, ReusablePages, OutPages, OutFingerprints);
+	}
 
-		PDFAsset->PageRange = FPageRange(FirstPage, LastPage);
-		PDFAsset->Dpi = Dpi;
-		PDFAsset->Pages = Buffer;
+	// ǂݍ񂾉摜̓LbVɈڂ
+	if (bIsSucceeded && !CacheStagingPath.IsEmpty())
+	{
+		TArray<FString> PageNames;
+		FileManager.FindFiles(PageNames, *TempDirPath, *Extension);
+		for (const FString& PageName : PageNames)
+		{
+			// ̍ƃfBNg͕ʂ̃t@CVXeւ̈ړɂȂ̂ŁAsRs[
+			const FString SourcePath = FPaths::Combine(TempDirPath, PageName);
+			const FString DestinationPath = FPaths::Combine(CacheStagingPath, PageName);
+			if (!FileManager.Move(*DestinationPath, *SourcePath))
+			{
+				FileManager.Copy(*DestinationPath, *SourcePath);
+			}
+		}
 	}
 
 	// ƃfBNg폜
@@ -131,224 +444,703 @@ UPDF* FGhostscriptCore::ConvertPdfToPdfAsset(const FString& InputPath, int Dpi,
 		UE_LOG(PDFImporter, Log, TEXT("Successfully deleted working directory (%s)"), *TempDirPath);
 	}
 
-	return PDFAsset;
+	return bIsSucceeded;
 }
 
-bool FGhostscriptCore::ConvertPdfToJpeg(const FString& InputPath, const FString& OutputPath, int Dpi, int FirstPage, int LastPage)
+bool FGhostscriptCore::LoadPagesFromDirectory(const FString& DirectoryPath, const FString& Extension, const FString& Filename, bool bIsImportIntoEditor, const FPDFPageLoadedCallback& OnPageLoaded, FPDFConversionToken* Token, FPDFReusablePages* ReusablePages, TArray<UTexture2D*>& OutPages, TArray<uint64>& OutFingerprints)
 {
-	if (!(FirstPage > 0 && LastPage > 0 && FirstPage <= LastPage))
+	IFileManager& FileManager = IFileManager::Get();
+
+	// 摜̃t@CpX擾
+	TArray<FString> PageNames;
+	FileManager.FindFiles(PageNames, *DirectoryPath, *Extension);
+	PageNames.Sort();
+
+	struct FDecodedPage
 	{
-		FirstPage = 1;
-		LastPage = INT_MAX;
-	}
-
-	TArray<char> FirstPageBuffer = FStringToCharPtr(FString(TEXT("-dFirstPage=") + FString::FromInt(FirstPage)));
-	TArray<char> LastPageBuffer = FStringToCharPtr(FString(TEXT("-dLastPage=") + FString::FromInt(LastPage)));
-	TArray<char> DpiXBuffer = FStringToCharPtr(FString(TEXT("-dDEVICEXRESOLUTION=") + FString::FromInt(Dpi)));
-	TArray<char> DpiYBuffer = FStringToCharPtr(FString(TEXT("-dDEVICEYRESOLUTION=") + FString::FromInt(Dpi)));
-	TArray<char> OutputPathBuffer = FStringToCharPtr(FString(TEXT("-sOutputFile=") + OutputPath));
-	TArray<char> InputPathBuffer = FStringToCharPtr(InputPath);
-
-	const char* Args[20] =
-	{
-		// GhostscriptWo͂ɏo͂Ȃ悤
-		"-q",
-		"-dQUIET",
-
-		"-dPARANOIDSAFER",			// Z[t[hŎs
-		"-dBATCH",					// GhostscriptC^NeBu[hɂȂȂ悤
-		"-dNOPAUSE",				// y[WƂ̈ꎞ~Ȃ悤
-		"-dNOPROMPT",				// R}hvvgłȂ悤           
-		"-dMaxBitmap=500000000",	// ptH[}Xコ
-		"-dNumRenderingThreads=4",	// }`RAŎs
-
-		// o͉摜̃A`GCAX𑜓xȂ
-		"-dAlignToPixels=0",
-		"-dGridFitTT=0",
-		"-dTextAlphaBits=4",
-		"-dGraphicsAlphaBits=4",
-
-		"-sDEVICE=jpeg",	// jpeg`ŏo
-		"-sPAPERSIZE=a7",	// ̃TCY
-
-		FirstPageBuffer.GetData(),	// 14 : n߂̃y[Ww
-		LastPageBuffer.GetData(),	// 15 : Ĩy[Ww
-		DpiXBuffer.GetData(),		// 16 : DPI
-		DpiYBuffer.GetData(),		// 17 : cDPI
-		OutputPathBuffer.GetData(), // 18 : o̓pX
-		InputPathBuffer.GetData()	// 19 : ̓pX
+		bool bIsDecoded = false;
+		int Width = 0;
+		int Height = 0;
+		TArray<uint8> Pixels;
+		EPixelFormat PixelFormat = PF_B8G8R8A8;
+		int NumMips = 1;
+
+		// ~bv֒ڏ܂ꂽꍇ̃eNX`i\[X点邾ł悢j
+		UTexture2D* Texture = nullptr;
 	};
 
-	// Ghostscript̃CX^X쐬
-	void* GhostscriptInstance = nullptr;
-	CreateInstance(&GhostscriptInstance, 0);
-	if (GhostscriptInstance != nullptr)
+	// 񈳏k̉摜͔zoRA}bvt@C̍ss̃eNX`̃~bv֒ڏ
+	// mۂ̓Q[Xbh̎̃t[҂̂ŁÃXbhQ[Xbh̏ꍇ͎gȂ
+	const bool bCopyIntoMips = !bIsImportIntoEditor && !bCompressRuntimePages && !IsInGameThread() && !Extension.Equals(TEXT("jpg"), ESearchCase::IgnoreCase);
+
+	// fR[hy[W𗭂ߍ݂Ȃ悤ɁA[J[̐ɍ킹ɃfR[h
+	const int BatchSize = (FTaskGraphInterface::Get().GetNumWorkerThreads() + 1) * 2;
+	TArray<FDecodedPage> DecodedPages;
+	UTexture2D* TextureTemp;
+	for (int BatchStart = 0; BatchStart < PageNames.Num(); BatchStart += BatchSize)
 	{
-		// Ghostscripts
-		int Result = Init(GhostscriptInstance, 20, (char**)Args);
+		// ܂Ƃ܂̊ԂŃLZmF
+		if (Token != nullptr && Token->IsCanceled())
+		{
+			return false;
+		}
+
+		const int NumPagesInBatch = FMath::Min(BatchSize, PageNames.Num() - BatchStart);
+		DecodedPages.Reset();
+		DecodedPages.SetNum(NumPagesInBatch);
+
+		// t@CɃ}bvăwb_[傫ǂ݁A܂Ƃ܂̃̕eNX`܂Ƃ߂ĊmۂĂ炤
+		TArray<TUniquePtr<FRawPageFile>> RawPageFiles;
+		TArray<TFuture<UTexture2D*>> Allocations;
+		if (bCopyIntoMips)
+		{
+			RawPageFiles.SetNum(NumPagesInBatch);
+			Allocations.SetNum(NumPagesInBatch);
+			for (int Index = 0; Index < NumPagesInBatch; ++Index)
+			{
+				TUniquePtr<FRawPageFile> RawPageFile = MakeUnique<FRawPageFile>();
+				if (RawPageFile->Open(FPaths::Combine(DirectoryPath, PageNames[BatchStart + Index])))
+				{
+					const int NumMips = bGeneratePageMips ? FPageMipGenerator::GetNumMips(RawPageFile->GetWidth(), RawPageFile->GetHeight()) : 1;
+					Allocations[Index] = TextureUploader->Allocate(RawPageFile->GetWidth(), RawPageFile->GetHeight(), NumMips, Token);
+					RawPageFiles[Index] = MoveTemp(RawPageFile);
+				}
+			}
+		}
 
-		// GhostscriptI
-		Exit(GhostscriptInstance);
-		DeleteInstance(GhostscriptInstance);
+		ParallelFor(NumPagesInBatch, [this, &DecodedPages, &PageNames, &DirectoryPath, &RawPageFiles, &Allocations, BatchStart, Token, bIsImportIntoEditor, bCopyIntoMips](int32 Index)
+		{
+			FDecodedPage& DecodedPage = DecodedPages[Index];
+			if (bCopyIntoMips)
+			{
+				UTexture2D* Texture = Allocations[Index].IsValid() ? Allocations[Index].Get() : nullptr;
+				if (Texture == nullptr)
+				{
+					return;
+				}
 
-		UE_LOG(PDFImporter, Log, TEXT("Ghostscript Return Code : %d"), Result);
+				// ܂ȂeNX`͔j
+				if (Token != nullptr && Token->IsCanceled())
+				{
+					TextureUploader->Release(Texture);
+					return;
+				}
 
-		return Result == 0;
+				// }bvt@C̍sԏ̃~bvփRs[A牺̃~bv
+				uint8* TopMip = (uint8*)Texture->PlatformData->Mips[0].BulkData.Lock(LOCK_READ_WRITE);
+				RawPageFiles[Index]->CopyToBGRA(TopMip);
+				FillLowerMips(Texture, TopMip);
+				RawPageFiles[Index].Reset();
+
+				DecodedPage.Width = Texture->GetSizeX();
+				DecodedPage.Height = Texture->GetSizeY();
+				DecodedPage.Texture = Texture;
+				DecodedPage.bIsDecoded = true;
+				return;
+			}
+
+			if (Token != nullptr && Token->IsCanceled())
+			{
+				return;
+			}
+
+			DecodedPage.bIsDecoded = DecoderPool->Decode(FPaths::Combine(DirectoryPath, PageNames[BatchStart + Index]), DecodedPage.Width, DecodedPage.Height, DecodedPage.Pixels);
+
+			// s̃eNX`̃~bv쐬ƈk̓fR[hXbhł̂܂܍s
+			if (DecodedPage.bIsDecoded && !bIsImportIntoEditor)
+			{
+				EncodeRuntimePage(DecodedPage.Width, DecodedPage.Height, DecodedPage.Pixels, DecodedPage.PixelFormat, DecodedPage.NumMips);
+			}
+		});
+
+		// s̃eNX`͂܂Ƃ߂ăQ[XbhɑA\Zɍ킹Đt[ɕč쐬Ă炤
+		TArray<TFuture<UTexture2D*>> Uploads;
+		if (!bIsImportIntoEditor)
+		{
+			for (FDecodedPage& DecodedPage : DecodedPages)
+			{
+				if (DecodedPage.Texture != nullptr)
+				{
+					Uploads.Add(TextureUploader->Commit(DecodedPage.Texture));
+				}
+				else
+				{
+					Uploads.Add(DecodedPage.bIsDecoded ? TextureUploader->Upload(nullptr, DecodedPage.Width, DecodedPage.Height, MoveTemp(DecodedPage.Pixels), DecodedPage.PixelFormat, DecodedPage.NumMips, Token) : TFuture<UTexture2D*>());
+				}
+			}
+		}
+
+		// eNX`̍쐬ƒʒm̓y[WɌĂяõXbhōs
+		for (int Index = 0; Index < NumPagesInBatch; ++Index)
+		{
+			if (Token != nullptr && Token->IsCanceled())
+			{
+				// 쐬҂ĂeNX`̓g[Nێ̂ŁAg[NɏI点
+				for (TFuture<UTexture2D*>& Upload : Uploads)
+				{
+					if (Upload.IsValid())
+					{
+						Upload.Wait();
+					}
+				}
+				return false;
+			}
+
+			// ǂݍ߂Ȃy[WĂAʒmƍėpɂ͎ۂ̃y[Wԍg
+			const int PageIndex = BatchStart + Index;
+			FDecodedPage& DecodedPage = DecodedPages[Index];
+			bool bResult = false;
+			uint64 Fingerprint = 0;
+			if (DecodedPage.bIsDecoded)
+			{
+				if (bIsImportIntoEditor)
+				{
+#if WITH_EDITORONLY_DATA
+					bResult = CreatePageTextureAsset(Filename, PageIndex, DecodedPage.Width, DecodedPage.Height, DecodedPage.Pixels, ReusablePages, TextureTemp, Fingerprint);
+#endif
+				}
+				else
+				{
+					TextureTemp = Uploads[Index].IsValid() ? Uploads[Index].Get() : nullptr;
+					bResult = TextureTemp != nullptr;
+				}
+			}
+			DecodedPage.Pixels.Empty();
+
+			if (bResult)
+			{
+				if (OnPageLoaded)
+				{
+					OnPageLoaded(PageIndex, TextureTemp);
+				}
+				OutPages.Add(TextureTemp);
+				OutFingerprints.Add(Fingerprint);
+			}
+
+			if (Token != nullptr)
+			{
+				Token->AddPageDone(FileManager.FileSize(*FPaths::Combine(DirectoryPath, PageNames[BatchStart + Index])));
+				Token->NotifyProgress();
+			}
+		}
 	}
-	else
+
+	return true;
+}
+
+bool FGhostscriptCore::LoadPagesFromBitmap(const FString& InputPath, int Dpi, int FirstPage, int LastPage, EPDFRasterizerBackend Backend, bool bIsImportIntoEditor, const FPDFPageLoadedCallback& OnPageLoaded, FPDFConversionToken* Token, const FString& CacheStagingPath, int PreviewDpi, FPDFReusablePages* ReusablePages, TArray<UTexture2D*>& OutPages, TArray<uint64>& OutFingerprints, bool& bOutIsComplete)
+{
+	bOutIsComplete = false;
+
+	IPDFRasterizer* Rasterizer = GetRasterizer(Backend);
+	if (Rasterizer == nullptr)
 	{
-		UE_LOG(PDFImporter, Error, TEXT("Failed to create Ghostscript instance"));
+		UE_LOG(PDFImporter, Error, TEXT("No rasterizer is available"));
 		return false;
 	}
-}
 
-bool FGhostscriptCore::LoadTexture2DFromFile(const FString& FilePath, class UTexture2D*& LoadedTexture)
-{
-	// 摜f[^ǂݍ
-	TArray<uint8> RawFileData;
-	if (FFileHelper::LoadFileToArray(RawFileData, *FilePath) &&
-		ImageWrapper.IsValid() && 
-		ImageWrapper->SetCompressed(RawFileData.GetData(), RawFileData.Num())
-		)
-	{
-		// 񈳏k̉摜f[^擾
-		const TArray<uint8>* UncompressedRawData = nullptr;
-		if (ImageWrapper->GetRaw(ERGBFormat::BGRA, 8, UncompressedRawData))
-		{
-			// Texture2D쐬
-			UTexture2D* NewTexture = UTexture2D::CreateTransient(ImageWrapper->GetWidth(), ImageWrapper->GetHeight(), PF_B8G8R8A8);
-			if (!NewTexture)
+	// eNX`AZbg̓TCYォςȂ̂ŁAvr[͎s̃eNX`ōs
+	const bool bIsProgressive = !bIsImportIntoEditor && PreviewDpi > 0 && PreviewDpi < Dpi;
+
+	// `̓obNOEhōsAeNX`̍쐬͂̃Xbhōs
+	struct FRenderedPage
+	{
+		int PageIndex;
+		bool bIsPreview;
+		FPDFPageBitmap Bitmap;
+
+		// ~bv֒ڕ`悳ꂽꍇ̃eNX`i\[X点邾ł悢j
+		UTexture2D* Texture;
+		int64 NumBytes;
+	};
+	TQueue<FRenderedPage, EQueueMode::Mpsc> RenderedPages;
+	FEvent* PageRenderedEvent = FPlatformProcess::GetSynchEventFromPool();
+
+	// vr[͑Sy[WႢ𑜓xŐɕ`悷isĂ{Ԃ̕`ɂ͉eȂj
+	TFuture<bool> PreviewResult;
+	if (bIsProgressive)
+	{
+		PreviewResult = AsyncPool(*RenderThreadPool, [&]()
+		{
+			const bool bResult = Rasterizer->StreamPdfToBitmap(InputPath, PreviewDpi, FirstPage, LastPage, [&](int PageIndex, FPDFPageBitmap& Bitmap)
 			{
-				return false;
+				const int64 PageBytes = Bitmap.GetNumBytes();
+				RenderedPages.Enqueue(FRenderedPage{ PageIndex, true, MoveTemp(Bitmap), nullptr, PageBytes });
+				PageRenderedEvent->Trigger();
+			}, Token);
+
+			PageRenderedEvent->Trigger();
+			return bResult;
+		});
+	}
+
+	// s̃eNX`͐Ƀ~bvmۂĂ炢A`挋ʂ֒ڏ܂
+	// ~bṽbNƉ͕`悷XbhōsÃXbh̓\[X̍쐬˗邾ɂ
+	// mۂ̓Q[Xbh̎̃t[҂̂ŁÃXbhQ[Xbh̏ꍇ͎gȂ
+	// vr[ւeNX`̓TCYς̂ŁA܂Œʂrbg}bv珑
+	TMap<uint8*, UTexture2D*> AllocatedTextures;
+	FCriticalSection AllocatedTexturesLock;
+	FPDFPageBufferAllocator AllocatePageBuffer;
+
+	// mۂ1y[W҂1t[1y[W`łȂ̂ŁÃy[W傫ƌŐɗvĂ
+	// 傫̈Ⴄy[WA܂łɗvĂeNX`͕`悪IĂj
+	struct FPrefetchedTexture
+	{
+		FIntPoint Size;
+		TFuture<UTexture2D*> Texture;
+	};
+	const int NumPrefetchedTextures = 4;
+	TArray<FPrefetchedTexture> PrefetchedTextures;
+	TArray<TFuture<UTexture2D*>> UnusedTextures;
+
+	if (!bIsImportIntoEditor && !bIsProgressive && !bCompressRuntimePages && !IsInGameThread())
+	{
+		AllocatePageBuffer.Allocate = [this, &AllocatedTextures, &AllocatedTexturesLock, &PrefetchedTextures, &UnusedTextures, NumPrefetchedTextures, Token](int Width, int Height) -> uint8*
+		{
+			const FIntPoint Size(Width, Height);
+			const int NumMips = bGeneratePageMips ? FPageMipGenerator::GetNumMips(Width, Height) : 1;
+			TFuture<UTexture2D*> Allocation;
+			{
+				FScopeLock Lock(&AllocatedTexturesLock);
+				for (int Index = PrefetchedTextures.Num() - 1; Index >= 0; --Index)
+				{
+					if (PrefetchedTextures[Index].Size != Size)
+					{
+						UnusedTextures.Add(MoveTemp(PrefetchedTextures[Index].Texture));
+						PrefetchedTextures.RemoveAt(Index);
+					}
+				}
+
+				if (PrefetchedTextures.Num() > 0)
+				{
+					Allocation = MoveTemp(PrefetchedTextures[0].Texture);
+					PrefetchedTextures.RemoveAt(0);
+				}
+				else
+				{
+					Allocation = TextureUploader->Allocate(Width, Height, NumMips, Token);
+				}
+
+				while (PrefetchedTextures.Num() < NumPrefetchedTextures)
+				{
+					PrefetchedTextures.Add(FPrefetchedTexture{ Size, TextureUploader->Allocate(Width, Height, NumMips, Token) });
+				}
 			}
 
-			// sNZf[^eNX`ɏ
-			void* TextureData = NewTexture->PlatformData->Mips[0].BulkData.Lock(LOCK_READ_WRITE);
-			FMemory::Memcpy(TextureData, UncompressedRawData->GetData(), UncompressedRawData->Num());
-			NewTexture->PlatformData->Mips[0].BulkData.Unlock();
-			NewTexture->UpdateResource();
+			UTexture2D* Texture = Allocation.Get();
+			if (Texture == nullptr)
+			{
+				return nullptr;
+			}
 
-			LoadedTexture = NewTexture;
+			uint8* Buffer = (uint8*)Texture->PlatformData->Mips[0].BulkData.Lock(LOCK_READ_WRITE);
+			FScopeLock Lock(&AllocatedTexturesLock);
+			AllocatedTextures.Add(Buffer, Texture);
+			return Buffer;
+		};
 
-			return true;
-		}
+		// `ɎsēnȂy[W̃eNX`͔j
+		AllocatePageBuffer.Release = [this, &AllocatedTextures, &AllocatedTexturesLock](uint8* Buffer)
+		{
+			UTexture2D* Texture = nullptr;
+			{
+				FScopeLock Lock(&AllocatedTexturesLock);
+				AllocatedTextures.RemoveAndCopyValue(Buffer, Texture);
+			}
+			if (Texture != nullptr)
+			{
+				Texture->PlatformData->Mips[0].BulkData.Unlock();
+				TextureUploader->Release(Texture);
+			}
+		};
 	}
-	
-	return false;
-}
 
+	TFuture<bool> RenderResult = AsyncPool(*RenderThreadPool, [&]()
+	{
+		const bool bResult = Rasterizer->StreamPdfToBitmap(InputPath, Dpi, FirstPage, LastPage, [&](int PageIndex, FPDFPageBitmap& Bitmap)
+		{
+			const int64 PageBytes = Bitmap.GetNumBytes();
+
+			// LbVւ݂͕̏`悵Xbhōs
+			if (!CacheStagingPath.IsEmpty())
+			{
+				FPDFRenderCache::WriteBitmap(FPaths::Combine(CacheStagingPath, FString::Printf(TEXT("%010d.bmp"), PageIndex)), Bitmap);
+			}
+
+			// ~bv֒ڕ`悳ꂽy[ẂAŉ̃~bvăbNO
+			UTexture2D* Texture = nullptr;
+			if (Bitmap.Buffer != nullptr)
+			{
+				{
+					FScopeLock Lock(&AllocatedTexturesLock);
+					AllocatedTextures.RemoveAndCopyValue(Bitmap.Buffer, Texture);
+				}
+				if (Texture != nullptr)
+				{
+					FillLowerMips(Texture, Bitmap.Buffer);
+				}
+				Bitmap.Buffer = nullptr;
+			}
+
+			RenderedPages.Enqueue(FRenderedPage{ PageIndex, false, MoveTemp(Bitmap), Texture, PageBytes });
+			PageRenderedEvent->Trigger();
+		}, Token, AllocatePageBuffer);
+
+		PageRenderedEvent->Trigger();
+		return bResult;
+	});
+
+	// `悪Iy[W珇ɃeNX`쐬
+	const FString Filename = FPaths::GetBaseFilename(InputPath);
+	TMap<int, UTexture2D*> Textures;
+	TMap<int, uint64> Fingerprints;
+	TSet<int> FinalPages;
+	bool bIsRendering = true;
+	while (bIsRendering)
+	{
+		// ɊmFāA܂łɓ͂y[W肱ڂȂ悤ɂ
+		bIsRendering = !RenderResult.IsReady() || (PreviewResult.IsValid() && !PreviewResult.IsReady());
+
+		FRenderedPage RenderedPage;
+		while (RenderedPages.Dequeue(RenderedPage))
+		{
+			FPDFPageBitmap& Bitmap = RenderedPage.Bitmap;
+			UTexture2D** PreviewTexture = Textures.Find(RenderedPage.PageIndex);
+
+			// {Ԃ̕`̕ɓ͂y[W̃vr[͎gȂ
+			if (RenderedPage.bIsPreview && PreviewTexture != nullptr)
+			{
+				continue;
+			}
+
+			UTexture2D* TextureTemp = nullptr;
+			bool bResult = false;
+			if (PreviewTexture != nullptr)
+			{
+				// vr[ƓeNX`ŏIIȉ𑜓xɍւ
+				TextureTemp = *PreviewTexture;
+				EPixelFormat PixelFormat;
+				int NumMips;
+				EncodeRuntimePage(Bitmap.Width, Bitmap.Height, Bitmap.Pixels, PixelFormat, NumMips);
+				bResult = UpdateTexture2DFromBitmap(TextureTemp, Bitmap.Width, Bitmap.Height, MoveTemp(Bitmap.Pixels), PixelFormat, NumMips);
+			}
+			else if (RenderedPage.Texture != nullptr)
+			{
+				// `挋ʂ͂eNX`̃~bvɂ̂ŁA\[X点邾ł悢
+				TextureTemp = RenderedPage.Texture;
+				bResult = TextureUploader->Commit(TextureTemp).Get() != nullptr;
+			}
+			else if (bIsImportIntoEditor)
+			{
 #if WITH_EDITORONLY_DATA
-bool FGhostscriptCore::CreateTextureAssetFromFile(const FString& FilePath, class UTexture2D*& LoadedTexture)
-{
-	// 摜f[^ǂݍ
-	TArray<uint8> RawFileData;
-	if (FFileHelper::LoadFileToArray(RawFileData, *FilePath))
-	{
-		// 񈳏k̉摜f[^擾
-		const TArray<uint8>* UncompressedRawData = nullptr;
-		if (ImageWrapper.IsValid() &&
-			ImageWrapper->SetCompressed(RawFileData.GetData(), RawFileData.Num()) &&
-			ImageWrapper->GetRaw(ERGBFormat::BGRA, 8, UncompressedRawData)
-			)
-		{
-			FString Filename = FPaths::GetBaseFilename(FilePath);
-			Filename = Filename.Left(Filename.Len() - 10);
-			int Width = ImageWrapper->GetWidth();
-			int Height = ImageWrapper->GetHeight();
-
-			// pbP[W쐬
-			FString PackagePath(TEXT("/PDFImporter/") + Filename + TEXT("/"));
-			FString AbsolutePackagePath = PagesDirectoryPath + TEXT("/") + Filename + TEXT("/");
-
-			FPackageName::RegisterMountPoint(PackagePath, AbsolutePackagePath);
-
-			PackagePath += Filename;
-
-			UPackage* Package = CreatePackage(nullptr, *PackagePath);
-			Package->FullyLoad();
-
-			// eNX`쐬
-			FName TextureName = MakeUniqueObjectName(Package, UTexture2D::StaticClass(), FName(*Filename));
-			UTexture2D* NewTexture = NewObject<UTexture2D>(Package, TextureName, RF_Public | RF_Standalone);
-
-			// eNX`̐ݒ
-			NewTexture->PlatformData = new FTexturePlatformData();
-			NewTexture->PlatformData->SizeX = Width;
-			NewTexture->PlatformData->SizeY = Height;
-			NewTexture->MipGenSettings = TextureMipGenSettings::TMGS_NoMipmaps;
-			NewTexture->NeverStream = false;
-
-			// sNZf[^eNX`ɏ
-			FTexture2DMipMap* Mip = new FTexture2DMipMap();
-			NewTexture->PlatformData->Mips.Add(Mip);
-			Mip->SizeX = Width;
-			Mip->SizeY = Height;
-			Mip->BulkData.Lock(LOCK_READ_WRITE);
-			uint8* TextureData = (uint8*)Mip->BulkData.Realloc(UncompressedRawData->Num());
-			FMemory::Memcpy(TextureData, UncompressedRawData->GetData(), UncompressedRawData->Num());
-			Mip->BulkData.Unlock();
-
-			// eNX`XV
-			NewTexture->AddToRoot();
-			NewTexture->Source.Init(Width, Height, 1, 1, ETextureSourceFormat::TSF_BGRA8, UncompressedRawData->GetData());
-			NewTexture->UpdateResource();
-
-			// pbP[Wۑ
-			Package->MarkPackageDirty();
-			FAssetRegistryModule::AssetCreated(NewTexture);
-			LoadedTexture = NewTexture;
-
-			FString PackageFilename = FPackageName::LongPackageNameToFilename(PackagePath, FPackageName::GetAssetPackageExtension());
-			return UPackage::SavePackage(Package, NewTexture, RF_Public | RF_Standalone, *PackageFilename, GError, nullptr, true, true, SAVE_NoError);
+				uint64 Fingerprint = 0;
+				bResult = CreatePageTextureAsset(Filename, RenderedPage.PageIndex, Bitmap.Width, Bitmap.Height, Bitmap.Pixels, ReusablePages, TextureTemp, Fingerprint);
+				Fingerprints.Add(RenderedPage.PageIndex, Fingerprint);
+#endif
+			}
+			else
+			{
+				EPixelFormat PixelFormat;
+				int NumMips;
+				EncodeRuntimePage(Bitmap.Width, Bitmap.Height, Bitmap.Pixels, PixelFormat, NumMips);
+				bResult = LoadTexture2DFromBitmap(Bitmap.Width, Bitmap.Height, MoveTemp(Bitmap.Pixels), TextureTemp, PixelFormat, NumMips, Token);
+			}
+
+			if (bResult)
+			{
+				Textures.Add(RenderedPage.PageIndex, TextureTemp);
+				if (OnPageLoaded)
+				{
+					OnPageLoaded(RenderedPage.PageIndex, TextureTemp);
+				}
+			}
+
+			if (!RenderedPage.bIsPreview)
+			{
+				FinalPages.Add(RenderedPage.PageIndex);
+				if (Token != nullptr)
+				{
+					Token->AddPageDone(RenderedPage.NumBytes);
+				}
+			}
+
+			// gIy[W̃͂ɉ
+			Bitmap.Pixels.Empty();
+		}
+
+		if (Token != nullptr)
+		{
+			Token->NotifyProgress();
+		}
+
+		if (bIsRendering)
+		{
+			PageRenderedEvent->Wait(100);
+		}
+	}
+
+	FPlatformProcess::ReturnSynchEventToPool(PageRenderedEvent);
+
+	// ɗv܂܎gȂeNX`j
+	for (FPrefetchedTexture& PrefetchedTexture : PrefetchedTextures)
+	{
+		UnusedTextures.Add(MoveTemp(PrefetchedTexture.Texture));
+	}
+	for (TFuture<UTexture2D*>& UnusedTexture : UnusedTextures)
+	{
+		TextureUploader->Release(UnusedTexture.Get());
+	}
+
+	// rŕ`ɎsĂAʒmς݂̃y[W͎Ȃ̂ŕ`łʂƂĕԂ
+	// LZꂽꍇƁA1y[W`łȂꍇsɂ
+	bOutIsComplete = RenderResult.Get();
+	if (!bOutIsComplete && (FinalPages.Num() == 0 || (Token != nullptr && Token->IsCanceled())))
+	{
+		return false;
+	}
+
+	// y[Wɕׂi{Ԃ̕`悪y[W̓vr[̂܂܎cȂj
+	Textures.KeySort(TLess<int>());
+	for (const TPair<int, UTexture2D*>& Pair : Textures)
+	{
+		if (FinalPages.Contains(Pair.Key))
+		{
+			OutPages.Add(Pair.Value);
+			OutFingerprints.Add(Fingerprints.FindRef(Pair.Key));
 		}
 	}
 
-	return false;
+	if (!bOutIsComplete)
+	{
+		UE_LOG(PDFImporter, Warning, TEXT("Rendering stopped partway, only %d pages have been loaded (%s)"), OutPages.Num(), *InputPath);
+	}
+
+	return OutPages.Num() > 0;
 }
-#endif
 
-TArray<char> FGhostscriptCore::FStringToCharPtr(const FString& Text)
+bool FGhostscriptCore::LoadTexture2DFromBitmap(int Width, int Height, TArray<uint8>&& Pixels, class UTexture2D*& LoadedTexture, EPixelFormat PixelFormat, int NumMips, FPDFConversionToken* Owner)
 {
-	int Size = GetFStringSize(Text) + 1;
-	TArray<char> Buffer("", Size);
-	WideCharToMultiByte(CP_ACP, 0, *Text, Size, Buffer.GetData(), Buffer.Num(), NULL, NULL);
-	return Buffer;
+	LoadedTexture = TextureUploader->Upload(nullptr, Width, Height, MoveTemp(Pixels), PixelFormat, NumMips, Owner).Get();
+	return LoadedTexture != nullptr;
 }
 
-int FGhostscriptCore::GetFStringSize(const FString& InString)
+bool FGhostscriptCore::UpdateTexture2DFromBitmap(UTexture2D* Texture, int Width, int Height, TArray<uint8>&& Pixels, EPixelFormat PixelFormat, int NumMips)
 {
-	int Size = 0;
+	if (Texture == nullptr)
+	{
+		return false;
+	}
+
+	return TextureUploader->Upload(Texture, Width, Height, MoveTemp(Pixels), PixelFormat, NumMips).Get() != nullptr;
+}
 
-	for (TCHAR Char : InString)
+void FGhostscriptCore::EncodeRuntimePage(int& Width, int& Height, TArray<uint8>& Pixels, EPixelFormat& OutPixelFormat, int& OutNumMips) const
+{
+	OutPixelFormat = PF_B8G8R8A8;
+	OutNumMips = 1;
+	if (Pixels.Num() != (int64)Width * Height * 4 || Pixels.Num() == 0)
 	{
-		const char* Temp = TCHAR_TO_UTF8(*FString::Chr(Char));
-		uint8 Code = static_cast<uint8>(*Temp);
+		return;
+	}
 
-		if ((Code >= 0x00) && (Code <= 0x7f))
+	// keNX`͈ԏ̃~bvubNPʂ̑傫ɂĂk
+	// LƔzɎ܂ȂȂy[W͈kȂ
+	const FIntPoint PaddedSize = FPageCompressor::GetPaddedSize(Width, Height);
+	const bool bCompress = bCompressRuntimePages && (int64)PaddedSize.X * PaddedSize.Y * 4 <= MAX_int32;
+	if (bCompress)
+	{
+		FPageCompressor::PadToBlocks(Width, Height, Pixels);
+	}
+
+	if (bGeneratePageMips)
+	{
+		OutNumMips = FPageMipGenerator::GenerateMipChain(Width, Height, Pixels);
+	}
+
+	if (!bCompress)
+	{
+		return;
+	}
+
+	// ~bvƂɈkubNɒu
+	TArray<uint8> Blocks;
+	TArray<uint8> MipBlocks;
+	int64 Offset = 0;
+	for (int MipIndex = 0; MipIndex < OutNumMips; ++MipIndex)
+	{
+		const FIntPoint MipSize = FPageMipGenerator::GetMipSize(Width, Height, MipIndex);
+		FPageCompressor::CompressBC1(Pixels.GetData() + Offset, MipSize.X, MipSize.Y, MipBlocks);
+		Blocks.Append(MipBlocks);
+		Offset += (int64)MipSize.X * MipSize.Y * 4;
+	}
+	Pixels = MoveTemp(Blocks);
+	OutPixelFormat = PF_DXT1;
+}
+
+void FGhostscriptCore::FillLowerMips(UTexture2D* Texture, const uint8* TopMip)
+{
+	// 񂾃~bv珇ɏkĉ̃~bv
+	TIndirectArray<FTexture2DMipMap>& Mips = Texture->PlatformData->Mips;
+	for (int MipIndex = 1; MipIndex < Mips.Num(); ++MipIndex)
+	{
+		const uint8* SourceMip = (MipIndex == 1) ? TopMip : (const uint8*)Mips[MipIndex - 1].BulkData.Lock(LOCK_READ_ONLY);
+		uint8* DestMip = (uint8*)Mips[MipIndex].BulkData.Lock(LOCK_READ_WRITE);
+		FPageMipGenerator::Downsample(SourceMip, Mips[MipIndex - 1].SizeX, Mips[MipIndex - 1].SizeY, DestMip);
+		Mips[MipIndex].BulkData.Unlock();
+		if (MipIndex > 1)
 		{
-			Size += 1;
+			Mips[MipIndex - 1].BulkData.Unlock();
 		}
-		else if ((Code >= 0xc2) && (Code <= 0xdf))
+	}
+	Mips[0].BulkData.Unlock();
+}
+
+#if WITH_EDITORONLY_DATA
+bool FGhostscriptCore::CreatePageTextureAsset(const FString& Filename, int PageIndex, int Width, int Height, const TArray<uint8>& Pixels, FPDFReusablePages* ReusablePages, class UTexture2D*& LoadedTexture, uint64& OutFingerprint)
+{
+	// `挋ʂy[W͑ÕeNX`AZbĝ܂܎g
+	OutFingerprint = CityHash64((const char*)Pixels.GetData(), Pixels.Num());
+	if (ReusablePages != nullptr)
+	{
+		// ʒũy[WD悵Ay[W}폜łꂽꍇ͑̈ʒuT
+		int ReusedIndex = INDEX_NONE;
+		if (ReusablePages->Fingerprints.IsValidIndex(PageIndex) && ReusablePages->Fingerprints[PageIndex] == OutFingerprint && ReusablePages->Pages.IsValidIndex(PageIndex) && ReusablePages->Pages[PageIndex] != nullptr)
 		{
-			Size += 2;
+			ReusedIndex = PageIndex;
 		}
-		else if ((Code >= 0xe0) && (Code <= 0xef))
+		else
 		{
-			Size += 3;
+			for (int Index = 0; Index < ReusablePages->Fingerprints.Num() && Index < ReusablePages->Pages.Num(); ++Index)
+			{
+				if (ReusablePages->Fingerprints[Index] == OutFingerprint && ReusablePages->Pages[Index] != nullptr)
+				{
+					ReusedIndex = Index;
+					break;
+				}
+			}
 		}
-		else if ((Code >= 0xf0) && (Code <= 0xf7))
+
+		if (ReusedIndex != INDEX_NONE)
 		{
-			Size += 4;
+			UTexture2D* ReusedTexture = ReusablePages->Pages[ReusedIndex];
+			const int NumMips = bGeneratePageMips ? FPageMipGenerator::GetNumMips(Width, Height) : 1;
+			if (ReusedTexture->GetSizeX() == Width && ReusedTexture->GetSizeY() == Height && ReusedTexture->Source.GetNumMips() == NumMips && (bool)ReusedTexture->VirtualTextureStreaming == bImportAsVirtualTextures)
+			{
+				ReusablePages->Pages[ReusedIndex] = nullptr;
+				LoadedTexture = ReusedTexture;
+				UE_LOG(PDFImporter, Verbose, TEXT("Page %d is unchanged and reuses %s"), PageIndex + 1, *ReusedTexture->GetName());
+				return true;
+			}
 		}
-		else if ((Code >= 0xf8) && (Code <= 0xfb))
+	}
+
+	return CreateTextureAssetFromBitmap(Filename, PageIndex, Width, Height, Pixels, LoadedTexture);
+}
+
+bool FGhostscriptCore::CreateTextureAssetFromBitmap(const FString& Filename, int PageIndex, int Width, int Height, const TArray<uint8>& Pixels, class UTexture2D*& LoadedTexture)
+{
+	return CreateTextureAssetFromPixels(Filename, PageIndex, Width, Height, [&Pixels](uint8* TextureData) { FMemory::Memcpy(TextureData, Pixels.GetData(), Pixels.Num()); }, LoadedTexture);
+}
+
+bool FGhostscriptCore::CreateTextureAssetFromPixels(const FString& Filename, int PageIndex, int Width, int Height, TFunctionRef<void(uint8*)> WritePixels, class UTexture2D*& LoadedTexture)
+{
+	// pbP[W쐬
+	FString PackagePath(TEXT("/PDFImporter/") + Filename + TEXT("/"));
+	FString AbsolutePackagePath = PagesDirectoryPath + TEXT("/") + Filename + TEXT("/");
+
+	FPackageName::RegisterMountPoint(PackagePath, AbsolutePackagePath);
+
+	// y[WƂɕʂ̃pbP[WɂāAăC|[gŎg񂵂y[W̃pbP[W͕ۑȂ悤ɂ
+	// y[W̑ÕAZbg܂cĂꍇ͖O炷
+	FString PackageName;
+	FString PackageFilename;
+	for (int Suffix = 0; ; ++Suffix)
+	{
+		PackageName = PackagePath + FString::Printf(TEXT("%s_%d"), *Filename, PageIndex + 1);
+		if (Suffix > 0)
 		{
-			Size += 5;
+			PackageName += FString::Printf(TEXT("_%d"), Suffix);
 		}
-		else if ((Code >= 0xfc) && (Code <= 0xfd))
+
+		PackageFilename = FPackageName::LongPackageNameToFilename(PackageName, FPackageName::GetAssetPackageExtension());
+		if (FindPackage(nullptr, *PackageName) == nullptr && !IFileManager::Get().FileExists(*PackageFilename))
 		{
-			Size += 6;
+			break;
 		}
 	}
 
-	return Size;
+	UPackage* Package = CreatePackage(nullptr, *PackageName);
+	Package->FullyLoad();
+
+	// eNX`쐬
+	UTexture2D* NewTexture = NewObject<UTexture2D>(Package, FName(*FPackageName::GetShortName(PackageName)), RF_Public | RF_Standalone);
+
+	// eNX`̐ݒ
+	NewTexture->PlatformData = new FTexturePlatformData();
+	NewTexture->PlatformData->SizeX = Width;
+	NewTexture->PlatformData->SizeY = Height;
+	NewTexture->NeverStream = false;
+
+	// sNZf[^eNX`ɏ
+	FTexture2DMipMap* Mip = new FTexture2DMipMap();
+	NewTexture->PlatformData->Mips.Add(Mip);
+	Mip->SizeX = Width;
+	Mip->SizeY = Height;
+	Mip->BulkData.Lock(LOCK_READ_WRITE);
+	uint8* TextureData = (uint8*)Mip->BulkData.Realloc((int64)Width * Height * 4);
+	WritePixels(TextureData);
+
+	// eNX`XV
+	NewTexture->AddToRoot();
+	if (bGeneratePageMips)
+	{
+		// 쐬~bv̂܂܎g킹AXg[~OŕKvȃ~bvǂݍ߂悤ɂ
+		TArray64<uint8> MipChain(TextureData, (int64)Width * Height * 4);
+		const int NumMips = FPageMipGenerator::GenerateMipChain(Width, Height, MipChain);
+		NewTexture->Source.Init(Width, Height, 1, NumMips, ETextureSourceFormat::TSF_BGRA8, MipChain.GetData());
+		NewTexture->MipGenSettings = TextureMipGenSettings::TMGS_LeaveExistingMips;
+	}
+	else
+	{
+		NewTexture->Source.Init(Width, Height, 1, 1, ETextureSourceFormat::TSF_BGRA8, TextureData);
+		NewTexture->MipGenSettings = TextureMipGenSettings::TMGS_NoMipmaps;
+	}
+	Mip->BulkData.Unlock();
+
+	// zeNX`ɂƁATvOꂽ^Cǂݍ܂
+	NewTexture->VirtualTextureStreaming = bImportAsVirtualTextures;
+	if (!bImportAsVirtualTextures && (uint32)FMath::Max(Width, Height) > NewTexture->GetMaximumDimension())
+	{
+		UE_LOG(PDFImporter, Warning, TEXT("%s (%dx%d) exceeds the maximum texture size of %d and will be downscaled. Import as virtual textures to keep the full resolution."), *Filename, Width, Height, NewTexture->GetMaximumDimension());
+	}
+
+	// ݒɍ킹ăubNk
+	switch (GetDefault<UPDFImporterSettings>()->ImportCompression)
+	{
+	case EPDFPageCompression::None:
+		NewTexture->CompressionSettings = TextureCompressionSettings::TC_VectorDisplacementmap;
+		break;
+	case EPDFPageCompression::BC1:
+		NewTexture->CompressionSettings = TextureCompressionSettings::TC_Default;
+		NewTexture->CompressionNoAlpha = true;
+		break;
+	case EPDFPageCompression::BC7:
+		NewTexture->CompressionSettings = TextureCompressionSettings::TC_BC7;
+		break;
+	}
+
+	// k͑̃y[WƕsăobNOEhŐi߁ASy[WIĂ҂
+#if WITH_EDITOR
+	NewTexture->BeginCachePlatformData();
+#else
+	NewTexture->UpdateResource();
+#endif
+
+	// pbP[Wۑ
+	Package->MarkPackageDirty();
+	FAssetRegistryModule::AssetCreated(NewTexture);
+	LoadedTexture = NewTexture;
+
+	return UPackage::SavePackage(Package, NewTexture, RF_Public | RF_Standalone, *PackageFilename, GError, nullptr, true, true, SAVE_NoError);
 }
+#endif
@@ -0,0 +1,224 @@
+#include "GhostscriptDisplay.h"
+#include "PDFImporter.h"
+
+FGhostscriptDisplay::FGhostscriptDisplay()
+	: Image(nullptr), Width(0), Height(0), Raster(0), bIsPagePending(false)
+{
+	FMemory::Memzero(Callback);
+	Callback.display_open = &FGhostscriptDisplay::OnOpen;
+	Callback.display_preclose = &FGhostscriptDisplay::OnPreclose;
+	Callback.display_close = &FGhostscriptDisplay::OnClose;
+	Callback.display_presize = &FGhostscriptDisplay::OnPresize;
+	Callback.display_size = &FGhostscriptDisplay::OnSize;
+	Callback.display_sync = &FGhostscriptDisplay::OnSync;
+	Callback.display_page = &FGhostscriptDisplay::OnPage;
+	Callback.display_update = &FGhostscriptDisplay::OnUpdate;
+
+	// メモリ確保はGhostscriptに任せる
+	Callback.display_memalloc = nullptr;
+	Callback.display_memfree = nullptr;
+	Callback.display_separation = nullptr;
+	Callback.display_adjust_band_height = nullptr;
+
+	SetRectangleRequest(false);
+}
+
+void FGhostscriptDisplay::SetRectangleRequest(bool bEnable)
+{
+	if (bEnable)
+	{
+		// ページごとに描画先のメモリを渡すので、Ghostscriptはページ全体のフレームバッファを持たない
+		Callback.size = sizeof(FGhostscriptDisplayCallback);
+		Callback.version_major = GS_DISPLAY_VERSION_MAJOR;
+		Callback.display_rectangle_request = &FGhostscriptDisplay::OnRectangleRequest;
+	}
+	else
+	{
+		// 古いGhostscriptはバージョン2の大きさでないと受け付けない
+		Callback.size = STRUCT_OFFSET(FGhostscriptDisplayCallback, display_adjust_band_height);
+		Callback.version_major = GS_DISPLAY_VERSION_MAJOR_V2;
+		Callback.display_rectangle_request = nullptr;
+	}
+	Callback.version_minor = GS_DISPLAY_VERSION_MINOR;
+}
+
+void FGhostscriptDisplay::DiscardPendingPage()
+{
+	if (!bIsPagePending)
+	{
+		return;
+	}
+
+	if (PendingPage.Buffer != nullptr && PageAllocator.Release)
+	{
+		PageAllocator.Release(PendingPage.Buffer);
+	}
+	PendingPage = FPDFPageBitmap();
+	bIsPagePending = false;
+}
+
+FString FGhostscriptDisplay::GetHandleArgument() const
+{
+	// Ghostscriptはハンドルを16進数の文字列で受け取る
+	return FString::Printf(TEXT("-sDisplayHandle=16#%llx"), (uint64)(UPTRINT)this);
+}
+
+int FGhostscriptDisplay::OnOpen(void* Handle, void* Device)
+{
+	return 0;
+}
+
+int FGhostscriptDisplay::OnPreclose(void* Handle, void* Device)
+{
+	return 0;
+}
+
+int FGhostscriptDisplay::OnClose(void* Handle, void* Device)
+{
+	FGhostscriptDisplay* Display = static_cast<FGhostscriptDisplay*>(Handle);
+	Display->Image = nullptr;
+	Display->DiscardPendingPage();
+	return 0;
+}
+
+int FGhostscriptDisplay::OnPresize(void* Handle, void* Device, int Width, int Height, int Raster, unsigned int Format)
+{
+	// BGRA以外の形式は受け付けない
+	return (Format == GS_DISPLAY_FORMAT_BGRA) ? 0 : -1;
+}
+
+int FGhostscriptDisplay::OnSize(void* Handle, void* Device, int Width, int Height, int Raster, unsigned int Format, unsigned char* Image)
+{
+	FGhostscriptDisplay* Display = static_cast<FGhostscriptDisplay*>(Handle);
+	Display->Image = Image;
+	Display->Width = Width;
+	Display->Height = Height;
+	Display->Raster = Raster;
+	return 0;
+}
+
+int FGhostscriptDisplay::OnSync(void* Handle, void* Device)
+{
+	return 0;
+}
+
+int FGhostscriptDisplay::OnPage(void* Handle, void* Device, int Copies, int Flush)
+{
+	FGhostscriptDisplay* Display = static_cast<FGhostscriptDisplay*>(Handle);
+
+	// 矩形を要求させている場合は描画が終わった時点で渡している
+	if (Display->Callback.display_rectangle_request != nullptr)
+	{
+		return 0;
+	}
+
+	if (Display->Image == nullptr || Display->Width <= 0 || Display->Height <= 0 || !Display->PageHandler)
+	{
+		return -1;
+	}
+
+	// フレームバッファの内容をページとして取り出す
+	FPDFPageBitmap Page;
+	Page.Width = Display->Width;
+	Page.Height = Display->Height;
+
+	// 確保先が用意されていれば、フレームバッファから直接そこへ書き込む
+	uint8* Pixels = Display->PageAllocator.IsSet() ? Display->PageAllocator.Allocate(Page.Width, Page.Height) : nullptr;
+	if (Pixels != nullptr)
+	{
+		Page.Buffer = Pixels;
+	}
+	else
+	{
+		if (!Page.AllocatePixels())
+		{
+			UE_LOG(PDFImporter, Error, TEXT("Page of %dx%d is too large to render into memory"), Page.Width, Page.Height);
+			return -1;
+		}
+		Pixels = Page.Pixels.GetData();
+	}
+
+	// フレームバッファの行は揃えられているので、1行ずつコピーする
+	const int RowSize = Page.Width * 4;
+	for (int Y = 0; Y < Page.Height; ++Y)
+	{
+		FMemory::Memcpy(Pixels + (SIZE_T)Y * RowSize, Display->Image + (SIZE_T)Y * Display->Raster, RowSize);
+	}
+
+	Display->DeliverPage(Page);
+	return 0;
+}
+
+int FGhostscriptDisplay::OnUpdate(void* Handle, void* Device, int X, int Y, int W, int H)
+{
+	return 0;
+}
+
+int FGhostscriptDisplay::OnRectangleRequest(void* Handle, void* Device, void** Memory, int* OX, int* OY, int* Raster, int* PlaneRaster, int* X, int* Y, int* W, int* H)
+{
+	FGhostscriptDisplay* Display = static_cast<FGhostscriptDisplay*>(Handle);
+
+	// 2回目の要求はページ全体を描画し終えたことを表すので、空の矩形を返してページを渡す
+	if (Display->bIsPagePending)
+	{
+		*Memory = nullptr;
+		*X = *Y = *W = *H = 0;
+
+		FPDFPageBitmap Page = MoveTemp(Display->PendingPage);
+		Display->PendingPage = FPDFPageBitmap();
+		Display->bIsPagePending = false;
+		Display->DeliverPage(Page);
+		return 0;
+	}
+
+	if (Display->Width <= 0 || Display->Height <= 0 || !Display->PageHandler)
+	{
+		return -1;
+	}
+
+	// ページ全体を1つの矩形として、ページの行間隔で確保先のメモリへ直接描画させる
+	FPDFPageBitmap& Page = Display->PendingPage;
+	Page.Width = Display->Width;
+	Page.Height = Display->Height;
+	uint8* Pixels = Display->PageAllocator.IsSet() ? Display->PageAllocator.Allocate(Page.Width, Page.Height) : nullptr;
+	if (Pixels != nullptr)
+	{
+		Page.Buffer = Pixels;
+	}
+	else
+	{
+		if (!Page.AllocatePixels())
+		{
+			UE_LOG(PDFImporter, Error, TEXT("Page of %dx%d is too large to render into memory"), Page.Width, Page.Height);
+			Display->PendingPage = FPDFPageBitmap();
+			return -1;
+		}
+		Pixels = Page.Pixels.GetData();
+	}
+	Display->bIsPagePending = true;
+
+	*Memory = Pixels;
+	*OX = 0;
+	*OY = 0;
+	*Raster = Page.Width * 4;
+	*PlaneRaster = 0;
+	*X = 0;
+	*Y = 0;
+	*W = Page.Width;
+	*H = Page.Height;
+	return 0;
+}
+
+void FGhostscriptDisplay::DeliverPage(FPDFPageBitmap& Page)
+{
+	// 未使用のバイトをアルファとして不透明にする
+	uint8* Pixels = Page.Buffer != nullptr ? Page.Buffer : Page.Pixels.GetData();
+	const int64 NumBytes = (int64)Page.Width * Page.Height * 4;
+	for (int64 Index = 3; Index < NumBytes; Index += 4)
+	{
+		Pixels[Index] = 0xFF;
+	}
+
+	// 描画が終わったページはすぐに渡す
+	PageHandler(Page);
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IPDFRasterizer.h"
+
+// Display device format flags (mirrors gdevdsp.h of the Ghostscript sources)
+#define GS_DISPLAY_VERSION_MAJOR	3
+#define GS_DISPLAY_VERSION_MINOR	0
+#define GS_DISPLAY_VERSION_MAJOR_V2	2
+#define GS_DISPLAY_COLORS_RGB		(1 << 2)
+#define GS_DISPLAY_UNUSED_LAST		(1 << 7)
+#define GS_DISPLAY_DEPTH_8			(1 << 11)
+#define GS_DISPLAY_LITTLEENDIAN		(1 << 16)
+#define GS_DISPLAY_TOPFIRST			(1 << 17)
+
+// 32bit BGRx, top row first
+#define GS_DISPLAY_FORMAT_BGRA (GS_DISPLAY_COLORS_RGB | GS_DISPLAY_UNUSED_LAST | GS_DISPLAY_DEPTH_8 | GS_DISPLAY_LITTLEENDIAN | GS_DISPLAY_TOPFIRST)
+
+// First Ghostscript revision whose display device accepts version 3 of the callback table
+#define GS_DISPLAY_V3_REVISION		953
+
+// Callback table passed to gsapi_set_display_callback (display_callback_s, version 3)
+// Version 2 is the same table without the members after display_separation
+struct FGhostscriptDisplayCallback
+{
+	int size;
+	int version_major;
+	int version_minor;
+	int(*display_open)(void* Handle, void* Device);
+	int(*display_preclose)(void* Handle, void* Device);
+	int(*display_close)(void* Handle, void* Device);
+	int(*display_presize)(void* Handle, void* Device, int Width, int Height, int Raster, unsigned int Format);
+	int(*display_size)(void* Handle, void* Device, int Width, int Height, int Raster, unsigned int Format, unsigned char* Image);
+	int(*display_sync)(void* Handle, void* Device);
+	int(*display_page)(void* Handle, void* Device, int Copies, int Flush);
+	int(*display_update)(void* Handle, void* Device, int X, int Y, int W, int H);
+	void*(*display_memalloc)(void* Handle, void* Device, size_t Size);
+	int(*display_memfree)(void* Handle, void* Device, void* Memory);
+	int(*display_separation)(void* Handle, void* Device, int Component, const char* ComponentName, unsigned short C, unsigned short M, unsigned short Y, unsigned short K);
+	int(*display_adjust_band_height)(void* Handle, void* Device, int BandHeight);
+	int(*display_rectangle_request)(void* Handle, void* Device, void** Memory, int* OX, int* OY, int* Raster, int* PlaneRaster, int* X, int* Y, int* W, int* H);
+};
+
+// Receives the pages rendered by the Ghostscript display device
+class FGhostscriptDisplay
+{
+private:
+	FGhostscriptDisplayCallback Callback;
+
+	// Frame buffer owned by Ghostscript for the page being rendered, null when the pages are requested as rectangles
+	unsigned char* Image;
+	int Width;
+	int Height;
+	int Raster;
+
+	// Page whose memory was handed to Ghostscript by the rectangle request and is being rendered
+	FPDFPageBitmap PendingPage;
+	bool bIsPagePending;
+
+	// Receives the pages as they are rendered
+	TFunction<void(FPDFPageBitmap&)> PageHandler;
+
+	// Provides the memory the pages are rendered or copied into, or unset to use the Pixels of the bitmap
+	FPDFPageBufferAllocator PageAllocator;
+
+public:
+	// Constructor
+	FGhostscriptDisplay();
+
+	// Get the callback table to register with Ghostscript
+	FGhostscriptDisplayCallback* GetCallback() { return &Callback; }
+
+	// Get the value of -sDisplayHandle that identifies this instance
+	FString GetHandleArgument() const;
+
+	// Set the function that receives each rendered page
+	void SetPageHandler(TFunction<void(FPDFPageBitmap&)> InPageHandler) { PageHandler = MoveTemp(InPageHandler); }
+
+	// Set the functions that provide the memory each page is rendered into
+	void SetPageAllocator(FPDFPageBufferAllocator InPageAllocator) { PageAllocator = MoveTemp(InPageAllocator); }
+
+	// Let Ghostscript render each page straight into the memory of the page instead of its own frame buffer
+	// Only Ghostscript 9.53 or later knows the rectangle request, so call before registering the callback table
+	void SetRectangleRequest(bool bEnable);
+
+	// Give back the memory of a page that was not finished because the interpreter stopped
+	void DiscardPendingPage();
+
+private:
+	// Display device callbacks
+	static int OnOpen(void* Handle, void* Device);
+	static int OnPreclose(void* Handle, void* Device);
+	static int OnClose(void* Handle, void* Device);
+	static int OnPresize(void* Handle, void* Device, int Width, int Height, int Raster, unsigned int Format);
+	static int OnSize(void* Handle, void* Device, int Width, int Height, int Raster, unsigned int Format, unsigned char* Image);
+	static int OnSync(void* Handle, void* Device);
+	static int OnPage(void* Handle, void* Device, int Copies, int Flush);
+	static int OnUpdate(void* Handle, void* Device, int X, int Y, int W, int H);
+	static int OnRectangleRequest(void* Handle, void* Device, void** Memory, int* OX, int* OY, int* Raster, int* PlaneRaster, int* X, int* Y, int* W, int* H);
+
+	// Make the unused bytes opaque and pass the page on
+	void DeliverPage(FPDFPageBitmap& Page);
+};
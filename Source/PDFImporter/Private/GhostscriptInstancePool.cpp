@@ -0,0 +1,609 @@
+#include "GhostscriptInstancePool.h"
+#include "GhostscriptRasterizer.h"
+#include "Misc/ScopeLock.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/Event.h"
+#include "Misc/QueuedThreadPool.h"
+#include "AsyncExecTask.h"
+#include "PDFConversionToken.h"
+#include "PDF.h"
+
+// gsapi_add_control_path の種類 (GS_PERMIT_FILE_READING)
+#define GS_PERMIT_FILE_READING 0
+
+// PostScriptのエラー処理で捕まえられないエラー (gs_error_Fatal)
+#define GS_ERROR_FATAL -100
+
+// インタプリタは深く再帰することがあるので、描画スレッドのスタックは大きめに取る
+static const uint32 ShardThreadStackSize = 1024 * 1024;
+
+const int FGhostscriptInstancePool::DefaultPagesPerShard = 8;
+
+FGhostscriptInstancePool::FGhostscriptInstancePool(FGhostscriptRasterizer& InGhostscript)
+	: Ghostscript(InGhostscript)
+	, MaxIdleInstances(FGhostscriptRasterizer::GetDefaultNumRenderWorkers())
+	, ShardThreadPool(nullptr)
+{
+	// 呼び出し元のスレッドも1つの担当範囲を描画するので、残りのワーカーの分だけ用意する
+	ShardThreadPool = FQueuedThreadPool::Allocate();
+	ShardThreadPool->Create(FMath::Max(MaxIdleInstances - 1, 1), ShardThreadStackSize, TPri_BelowNormal);
+}
+
+FGhostscriptInstancePool::~FGhostscriptInstancePool()
+{
+	// 描画中の担当範囲が終わるのを待ってからインタプリタを終了させる
+	ShardThreadPool->Destroy();
+	delete ShardThreadPool;
+	ShardThreadPool = nullptr;
+
+	Empty();
+}
+
+int FGhostscriptInstancePool::GetPageCount(const FString& InputPath)
+{
+	TUniquePtr<FGhostscriptInstance> Instance = Acquire();
+	if (!Instance.IsValid())
+	{
+		return -1;
+	}
+
+	// ページ数を標準出力に書き出させて受け取る
+	const FString Program = FString::Printf(
+		TEXT("%s (r) file runpdfbegin pdfpagecount = flush runpdfend"),
+		*EscapePostScriptString(InputPath)
+	);
+
+	const bool bIsSucceeded = RunProgram(*Instance, InputPath, Program);
+	const FString Output = Instance->TakeOutput().TrimStartAndEnd();
+	Release(MoveTemp(Instance), bIsSucceeded);
+
+	if (!bIsSucceeded || !Output.IsNumeric())
+	{
+		return -1;
+	}
+
+	return FCString::Atoi(*Output);
+}
+
+bool FGhostscriptInstancePool::ProbePdf(const FString& InputPath, FPDFDocumentInfo& OutInfo)
+{
+	TUniquePtr<FGhostscriptInstance> Instance = Acquire();
+	if (!Instance.IsValid())
+	{
+		return false;
+	}
+
+	// ページを描画せずに、ページツリーと文書情報だけを1行ずつ標準出力に書き出させる
+	//   N <ページ数>
+	//   P <MediaBox 4値> <CropBox 4値> <Rotate>
+	//   I <キー> <16進数の文字列>（名前や数値の値は文字列にし、配列や辞書の値は書き出さない）
+	// 旧インタプリタのpget/oforceが無い場合（pdfi）はページ辞書から直接取得する
+	const FString Program = FString::Printf(TEXT(
+		"/pdfimporter_get { /pget where { pop pget } { 2 copy known { get true } { pop pop false } ifelse } ifelse } bind def "
+		"/pdfimporter_force { /oforce where { pop oforce } if } bind def "
+		"/pdfimporter_box { pdfimporter_get { pdfimporter_force { ( ) print pdfimporter_force =only } forall } { ( 0 0 0 0) print } ifelse } bind def "
+		"%s (r) file runpdfbegin "
+		"(N ) print pdfpagecount = "
+		"1 1 pdfpagecount { "
+			"pdfgetpage (P) print "
+			"dup /MediaBox pdfimporter_box "
+			"dup /CropBox pdfimporter_box "
+			"dup /Rotate pdfimporter_get { pdfimporter_force } { 0 } ifelse ( ) print =only () = pop "
+		"} for "
+		"Trailer /Info knownoget { { "
+			"pdfimporter_force "
+			"dup type /nametype eq { dup length string cvs } if "
+			"dup type /integertype eq 1 index type /realtype eq or 1 index type /booleantype eq or { 32 string cvs } if "
+			"dup type /stringtype eq { exch (I ) print =only ( ) print (%%stdout) (w) file exch writehexstring () = } { pop pop } ifelse "
+		"} forall } if "
+		"flush runpdfend"),
+		*EscapePostScriptString(InputPath)
+	);
+
+	const bool bIsSucceeded = RunProgram(*Instance, InputPath, Program);
+	TArray<FString> Lines;
+	Instance->TakeOutput().ParseIntoArrayLines(Lines);
+	Release(MoveTemp(Instance), bIsSucceeded);
+
+	if (!bIsSucceeded)
+	{
+		return false;
+	}
+
+	OutInfo = FPDFDocumentInfo();
+	for (const FString& Line : Lines)
+	{
+		if (Line.StartsWith(TEXT("N ")))
+		{
+			OutInfo.NumPages = FCString::Atoi(*Line.Mid(2));
+		}
+		else if (Line.StartsWith(TEXT("P ")))
+		{
+			TArray<FString> Values;
+			Line.Mid(2).ParseIntoArrayWS(Values);
+			if (Values.Num() < 9)
+			{
+				continue;
+			}
+
+			// 座標の順番は決まっていないので左下と右上に揃える
+			auto MakeBox = [&Values](int Offset)
+			{
+				const FVector2D A(FCString::Atof(*Values[Offset]), FCString::Atof(*Values[Offset + 1]));
+				const FVector2D B(FCString::Atof(*Values[Offset + 2]), FCString::Atof(*Values[Offset + 3]));
+				return FBox2D(FVector2D::Min(A, B), FVector2D::Max(A, B));
+			};
+
+			FPDFPageInfo PageInfo;
+			PageInfo.MediaBox = MakeBox(0);
+			PageInfo.CropBox = MakeBox(4);
+			if (PageInfo.CropBox.GetArea() <= 0.0f)
+			{
+				PageInfo.CropBox = PageInfo.MediaBox;
+			}
+			PageInfo.Rotation = ((FCString::Atoi(*Values[8]) % 360) + 360) % 360;
+			OutInfo.Pages.Add(PageInfo);
+		}
+		else if (Line.StartsWith(TEXT("I ")))
+		{
+			FString Key;
+			FString HexString;
+			if (!Line.Mid(2).Split(TEXT(" "), &Key, &HexString))
+			{
+				continue;
+			}
+
+			TArray<uint8> Bytes;
+			Bytes.SetNumUninitialized(HexString.Len() / 2);
+			Bytes.SetNum(HexToBytes(HexString.TrimStartAndEnd(), Bytes.GetData()));
+			OutInfo.Info.Add(Key, DecodePDFTextString(Bytes));
+		}
+	}
+
+	return OutInfo.NumPages > 0;
+}
+
+bool FGhostscriptInstancePool::StreamPdfToBitmap(const FString& InputPath, int Dpi, int FirstPage, int LastPage, const FPDFPageRenderedCallback& OnPageRendered, const FPDFConversionToken* Token, const FPDFPageBufferAllocator& AllocatePageBuffer)
+{
+	TUniquePtr<FGhostscriptInstance> Instance = Acquire();
+	if (!Instance.IsValid())
+	{
+		return false;
+	}
+
+	if (!(FirstPage > 0 && LastPage > 0 && FirstPage <= LastPage))
+	{
+		FirstPage = 1;
+		LastPage = INT_MAX;
+	}
+
+	// エラーが起きたインタプリタは状態が分からないので再利用しない
+	const FGhostscriptRenderBudget Budget = Ghostscript.MakeRenderBudget(Dpi, 1);
+	int NumPages = 0;
+	const bool bIsSucceeded = RenderPages(*Instance, InputPath, Dpi, Budget, FirstPage, LastPage, 0, OnPageRendered, Token, AllocatePageBuffer, NumPages);
+	Release(MoveTemp(Instance), bIsSucceeded);
+
+	return bIsSucceeded;
+}
+
+bool FGhostscriptInstancePool::StreamPdfToBitmapParallel(const FString& InputPath, int Dpi, int FirstPage, int LastPage, int NumWorkers, const FPDFPageRenderedCallback& OnPageRendered, const FPDFConversionToken* Token, const FPDFPageBufferAllocator& AllocatePageBuffer)
+{
+	// 範囲が分からなければ先にページ数を調べる（読み込んだインタプリタはそのまま描画に使われる）
+	if (NumWorkers > 1 && !(FirstPage > 0 && LastPage > 0 && FirstPage <= LastPage))
+	{
+		const int NumPages = GetPageCount(InputPath);
+		if (NumPages > 0)
+		{
+			FirstPage = 1;
+			LastPage = NumPages;
+		}
+	}
+
+	// ページより多いワーカーは文書を読むだけになるので起動しない
+	const bool bIsRangeKnown = FirstPage > 0 && LastPage > 0 && FirstPage <= LastPage;
+	if (bIsRangeKnown)
+	{
+		NumWorkers = FMath::Min(NumWorkers, LastPage - FirstPage + 1);
+	}
+
+	if (NumWorkers <= 1)
+	{
+		return StreamPdfToBitmap(InputPath, Dpi, FirstPage, LastPage, OnPageRendered, Token, AllocatePageBuffer);
+	}
+
+	// 範囲が分かっていればワーカー数で等分し、分からなければ一定のページ数ずつ割り当てる
+	int PagesPerShard = DefaultPagesPerShard;
+	if (bIsRangeKnown)
+	{
+		PagesPerShard = FMath::DivideAndRoundUp(LastPage - FirstPage + 1, NumWorkers);
+	}
+	else
+	{
+		FirstPage = 1;
+		LastPage = INT_MAX;
+	}
+
+	const FGhostscriptRenderBudget Budget = Ghostscript.MakeRenderBudget(Dpi, NumWorkers);
+
+	// 遅れて始まったワーカーが、描画を終えて戻った後のこの関数の変数に触れないようにする
+	struct FShardWorkers
+	{
+		FCriticalSection Lock;
+		int NumActiveWorkers = 0;
+		bool bIsClosed = false;
+		FEvent* WorkerFinishedEvent = FPlatformProcess::GetSynchEventFromPool();
+
+		~FShardWorkers() { FPlatformProcess::ReturnSynchEventToPool(WorkerFinishedEvent); }
+	};
+	TSharedRef<FShardWorkers, ESPMode::ThreadSafe> Workers = MakeShared<FShardWorkers, ESPMode::ThreadSafe>();
+
+	FThreadSafeCounter NextShard;
+	FThreadSafeCounter NumStartedWorkers;
+	FThreadSafeBool bIsEndOfDocument(false);
+	FThreadSafeBool bHasError(false);
+	FThreadSafeCounter NumRenderedPages;
+
+	auto RenderShards = [&]()
+	{
+		TUniquePtr<FGhostscriptInstance> Instance = Acquire();
+		if (!Instance.IsValid())
+		{
+			// インスタンスを作れなかった分は他のワーカーが処理する
+			return;
+		}
+		NumStartedWorkers.Increment();
+
+		bool bIsReusable = true;
+		while (!bIsEndOfDocument && !bHasError)
+		{
+			// 担当範囲の間でキャンセルを確認する
+			if (Token != nullptr && Token->IsCanceled())
+			{
+				bHasError = true;
+				break;
+			}
+
+			// 次の担当範囲を取得
+			const int Shard = NextShard.Increment() - 1;
+			const int64 ShardFirstPage = (int64)FirstPage + (int64)Shard * PagesPerShard;
+			if (ShardFirstPage > LastPage)
+			{
+				break;
+			}
+			const int ShardLastPage = (int)FMath::Min<int64>(ShardFirstPage + PagesPerShard - 1, LastPage);
+
+			// ページは描画された順にそのまま渡す
+			int NumPages = 0;
+			if (!RenderPages(*Instance, InputPath, Dpi, Budget, (int)ShardFirstPage, ShardLastPage, (int)(ShardFirstPage - FirstPage), OnPageRendered, Token, AllocatePageBuffer, NumPages))
+			{
+				bHasError = true;
+				bIsReusable = false;
+				break;
+			}
+			NumRenderedPages.Add(NumPages);
+
+			// 要求より少なければPDFの終わりに達している
+			if (NumPages < ShardLastPage - ShardFirstPage + 1)
+			{
+				bIsEndOfDocument = true;
+			}
+		}
+
+		Release(MoveTemp(Instance), bIsReusable);
+	};
+
+	// 呼び出し元以外のワーカーは専用のスレッドで動かす
+	for (int WorkerIndex = 1; WorkerIndex < NumWorkers; ++WorkerIndex)
+	{
+		auto WorkerTask = new FAutoDeleteAsyncTask<FAsyncExecTask>([Workers, &RenderShards]()
+		{
+			{
+				FScopeLock Lock(&Workers->Lock);
+				if (Workers->bIsClosed)
+				{
+					return;
+				}
+				++Workers->NumActiveWorkers;
+			}
+
+			RenderShards();
+
+			FScopeLock Lock(&Workers->Lock);
+			--Workers->NumActiveWorkers;
+			Workers->WorkerFinishedEvent->Trigger();
+		});
+		WorkerTask->StartBackgroundTask(ShardThreadPool);
+	}
+
+	// 呼び出し元のスレッドも描画し、始まっているワーカーが終わるのを待つ
+	RenderShards();
+	while (true)
+	{
+		{
+			FScopeLock Lock(&Workers->Lock);
+			if (Workers->NumActiveWorkers == 0)
+			{
+				Workers->bIsClosed = true;
+				break;
+			}
+		}
+		Workers->WorkerFinishedEvent->Wait(100);
+	}
+
+	if (bHasError || NumStartedWorkers.GetValue() == 0)
+	{
+		return false;
+	}
+
+	UE_LOG(PDFImporter, Log, TEXT("Rendered %d pages on %d workers"), NumRenderedPages.GetValue(), NumStartedWorkers.GetValue());
+	return true;
+}
+
+bool FGhostscriptInstancePool::RenderPages(FGhostscriptInstance& Instance, const FString& InputPath, int Dpi, const FGhostscriptRenderBudget& Budget, int FirstPage, int LastPage, int PageIndexOffset, const FPDFPageRenderedCallback& OnPageRendered, const FPDFConversionToken* Token, const FPDFPageBufferAllocator& AllocatePageBuffer, int& OutNumPages)
+{
+	if (Ghostscript.RunString == nullptr)
+	{
+		return false;
+	}
+
+	// 解像度と描画スレッド数などを変更してから指定範囲のページを描画する
+	const FString PostScriptPath = EscapePostScriptString(InputPath);
+	const FString Program = FString::Printf(
+		TEXT("<< /HWResolution [%d %d] /NumRenderingThreads %d /MaxBitmap %lld >> setpagedevice ")
+		TEXT("%s (r) file runpdfbegin process_trailer_attrs ")
+		TEXT("%d pdfpagecount %d 2 copy gt { exch } if pop dopdfpages ")
+		TEXT("runpdfend"),
+		Dpi, Dpi, Budget.NumRenderingThreads, Budget.MaxBitmap, *PostScriptPath, FirstPage, LastPage
+	);
+
+	// 描画されたページに通し番号を付けて渡す
+	OutNumPages = 0;
+	Instance.Display.SetPageHandler([&OnPageRendered, &OutNumPages, PageIndexOffset](FPDFPageBitmap& Page)
+	{
+		OnPageRendered(PageIndexOffset + OutNumPages, Page);
+		++OutNumPages;
+	});
+	Instance.Display.SetPageAllocator(AllocatePageBuffer);
+
+	Instance.Token = Token;
+	const bool bIsSucceeded = RunProgram(Instance, InputPath, Program);
+	Instance.Token = nullptr;
+
+	// 中断されて渡せなかったページのメモリを返す
+	Instance.Display.DiscardPendingPage();
+	Instance.Display.SetPageHandler(nullptr);
+	Instance.Display.SetPageAllocator(nullptr);
+	return bIsSucceeded;
+}
+
+bool FGhostscriptInstancePool::RunProgram(FGhostscriptInstance& Instance, const FString& InputPath, const FString& Program)
+{
+	if (Ghostscript.RunString == nullptr)
+	{
+		return false;
+	}
+
+	// 入力ファイルの読み込みを許可
+	TArray<char> PathBuffer = Ghostscript.FStringToCharPtr(InputPath);
+	if (Ghostscript.AddControlPath != nullptr)
+	{
+		Ghostscript.AddControlPath(Instance.Instance, GS_PERMIT_FILE_READING, PathBuffer.GetData());
+	}
+
+	// Ghostscriptを実行（標準出力はこのプログラムの分だけを残す）
+	Instance.Output.Empty();
+	TArray<char> ProgramBuffer = Ghostscript.FStringToCharPtr(Program);
+	int ExitCode = 0;
+	int Result = Ghostscript.RunString(Instance.Instance, ProgramBuffer.GetData(), 0, &ExitCode);
+
+	if (Ghostscript.RemoveControlPath != nullptr)
+	{
+		Ghostscript.RemoveControlPath(Instance.Instance, GS_PERMIT_FILE_READING, PathBuffer.GetData());
+	}
+
+	if (Instance.Token != nullptr && Instance.Token->IsCanceled())
+	{
+		UE_LOG(PDFImporter, Log, TEXT("Ghostscript conversion canceled (pooled)"));
+		return false;
+	}
+
+	UE_LOG(PDFImporter, Log, TEXT("Ghostscript Return Code : %d (pooled)"), Result);
+
+	return Result == 0;
+}
+
+void FGhostscriptInstancePool::Prewarm(int NumInstances)
+{
+	NumInstances = FMath::Min(NumInstances, MaxIdleInstances);
+
+	for (int Index = 0; Index < NumInstances; ++Index)
+	{
+		TUniquePtr<FGhostscriptInstance> Instance = CreateInstance();
+		if (!Instance.IsValid())
+		{
+			break;
+		}
+		Release(MoveTemp(Instance), true);
+	}
+}
+
+void FGhostscriptInstancePool::Empty()
+{
+	TArray<TUniquePtr<FGhostscriptInstance>> InstancesToDestroy;
+	{
+		FScopeLock Lock(&IdleInstancesLock);
+		InstancesToDestroy = MoveTemp(IdleInstances);
+	}
+
+	for (TUniquePtr<FGhostscriptInstance>& Instance : InstancesToDestroy)
+	{
+		DestroyInstance(MoveTemp(Instance));
+	}
+}
+
+TUniquePtr<FGhostscriptInstance> FGhostscriptInstancePool::Acquire()
+{
+	{
+		FScopeLock Lock(&IdleInstancesLock);
+		if (IdleInstances.Num() > 0)
+		{
+			return IdleInstances.Pop(false);
+		}
+	}
+
+	return CreateInstance();
+}
+
+void FGhostscriptInstancePool::Release(TUniquePtr<FGhostscriptInstance> Instance, bool bIsReusable)
+{
+	if (bIsReusable)
+	{
+		FScopeLock Lock(&IdleInstancesLock);
+		if (IdleInstances.Num() < MaxIdleInstances)
+		{
+			IdleInstances.Push(MoveTemp(Instance));
+			return;
+		}
+	}
+
+	DestroyInstance(MoveTemp(Instance));
+}
+
+TUniquePtr<FGhostscriptInstance> FGhostscriptInstancePool::CreateInstance(const TArray<FString>& ExtraArguments)
+{
+	TUniquePtr<FGhostscriptInstance> NewInstance = MakeUnique<FGhostscriptInstance>();
+
+	// Ghostscriptのインスタンスを作成
+	if (!Ghostscript.CreateGhostscriptInstance(*NewInstance, true))
+	{
+		return nullptr;
+	}
+
+	// ドキュメントを後から渡すため、入力ファイルと-dBATCHは指定しない
+	TArray<FString> Arguments = Ghostscript.MakeCommonArguments();
+	Arguments.Add(TEXT("-sDEVICE=display"));
+	Arguments.Add(FString::Printf(TEXT("-dDisplayFormat=%d"), GS_DISPLAY_FORMAT_BGRA));
+	Arguments.Add(NewInstance->Display.GetHandleArgument());
+	Arguments.Append(ExtraArguments);
+
+	TArray<TArray<char>> ArgumentBuffers;
+	TArray<char*> Args;
+	for (const FString& Argument : Arguments)
+	{
+		ArgumentBuffers.Add(Ghostscript.FStringToCharPtr(Argument));
+	}
+	for (TArray<char>& ArgumentBuffer : ArgumentBuffers)
+	{
+		Args.Add(ArgumentBuffer.GetData());
+	}
+
+	// インタプリタを初期化
+	int Result = Ghostscript.Init(NewInstance->Instance, Args.Num(), Args.GetData());
+	if (Result != 0)
+	{
+		UE_LOG(PDFImporter, Error, TEXT("Failed to initialize Ghostscript instance : %d"), Result);
+		DestroyInstance(MoveTemp(NewInstance));
+		return nullptr;
+	}
+
+	UE_LOG(PDFImporter, Log, TEXT("Pooled Ghostscript instance created"));
+	return NewInstance;
+}
+
+void FGhostscriptInstancePool::DestroyInstance(TUniquePtr<FGhostscriptInstance> Instance)
+{
+	if (Instance.IsValid() && Instance->Instance != nullptr)
+	{
+		Ghostscript.Exit(Instance->Instance);
+		Ghostscript.DeleteInstance(Instance->Instance);
+		Instance->Instance = nullptr;
+	}
+}
+
+FString FGhostscriptInstancePool::EscapePostScriptString(const FString& Text)
+{
+	FString Escaped = Text.Replace(TEXT("\\"), TEXT("\\\\"));
+	Escaped = Escaped.Replace(TEXT("("), TEXT("\\("));
+	Escaped = Escaped.Replace(TEXT(")"), TEXT("\\)"));
+	return TEXT("(") + Escaped + TEXT(")");
+}
+
+FString FGhostscriptInstancePool::DecodePDFTextString(const TArray<uint8>& Bytes)
+{
+	FString Decoded;
+
+	// UTF-16BE
+	// サロゲートペアはTCHARがUTF-32のプラットフォームでは1文字にまとめる必要があるので、UTF-16のまま集めてから変換する
+	if (Bytes.Num() >= 2 && Bytes[0] == 0xFE && Bytes[1] == 0xFF)
+	{
+		TArray<UTF16CHAR> CodeUnits;
+		for (int Index = 2; Index + 1 < Bytes.Num(); Index += 2)
+		{
+			CodeUnits.Add((UTF16CHAR)((Bytes[Index] << 8) | Bytes[Index + 1]));
+		}
+
+		FUTF16ToTCHAR Converted(CodeUnits.GetData(), CodeUnits.Num());
+		return FString(Converted.Length(), Converted.Get());
+	}
+
+	// UTF-8（PDF 2.0）
+	if (Bytes.Num() >= 3 && Bytes[0] == 0xEF && Bytes[1] == 0xBB && Bytes[2] == 0xBF)
+	{
+		FUTF8ToTCHAR Converted((const ANSICHAR*)Bytes.GetData() + 3, Bytes.Num() - 3);
+		return FString(Converted.Length(), Converted.Get());
+	}
+
+	// PDFDocEncodingは表示できる文字の大部分がLatin-1と同じ
+	for (uint8 Byte : Bytes)
+	{
+		Decoded.AppendChar((TCHAR)Byte);
+	}
+	return Decoded;
+}
+
+int FGhostscriptInstance::OnPoll(void* CallerHandle)
+{
+	// キャンセルされていればインタプリタを中断する
+	const FGhostscriptInstance* Instance = static_cast<const FGhostscriptInstance*>(CallerHandle);
+	if (Instance != nullptr && Instance->Token != nullptr && Instance->Token->IsCanceled())
+	{
+		return GS_ERROR_FATAL;
+	}
+
+	return 0;
+}
+
+int FGhostscriptInstance::OnStdin(void* CallerHandle, char* Buffer, int Length)
+{
+	// 標準入力からは何も渡さない
+	return 0;
+}
+
+int FGhostscriptInstance::OnStdout(void* CallerHandle, const char* Str, int Length)
+{
+	FGhostscriptInstance* Instance = static_cast<FGhostscriptInstance*>(CallerHandle);
+	if (Instance != nullptr)
+	{
+		// 文字の途中で区切られて渡されることがあるので、変換は実行し終えてからまとめて行う
+		Instance->Output.Append(Str, Length);
+	}
+
+	return Length;
+}
+
+FString FGhostscriptInstance::TakeOutput()
+{
+	FUTF8ToTCHAR Converted(Output.GetData(), Output.Num());
+	FString Text(Converted.Length(), Converted.Get());
+	Output.Empty();
+	return Text;
+}
+
+int FGhostscriptInstance::OnStderr(void* CallerHandle, const char* Str, int Length)
+{
+	FUTF8ToTCHAR Converted(Str, Length);
+	UE_LOG(PDFImporter, Log, TEXT("Ghostscript : %s"), *FString(Converted.Length(), Converted.Get()).TrimEnd());
+
+	return Length;
+}
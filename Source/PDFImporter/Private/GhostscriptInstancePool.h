@@ -0,0 +1,116 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GhostscriptDisplay.h"
+#include "HAL/CriticalSection.h"
+
+class FGhostscriptRasterizer;
+
+class FPDFConversionToken;
+struct FPDFDocumentInfo;
+
+// Ghostscript interpreter and the state its callbacks work on
+// Pooled instances stay initialized between documents
+struct FGhostscriptInstance
+{
+	// Instance returned by gsapi_new_instance
+	void* Instance;
+
+	// Display device bound to this instance at initialization
+	FGhostscriptDisplay Display;
+
+	// Token of the job being run, which aborts the interpreter when canceled
+	const FPDFConversionToken* Token;
+
+	// UTF-8 bytes written to stdout by the program being run
+	// Kept as bytes because a character may be split across two callbacks
+	TArray<ANSICHAR> Output;
+
+	FGhostscriptInstance() : Instance(nullptr), Token(nullptr) {}
+
+	// Convert the bytes written to stdout to text and clear them
+	FString TakeOutput();
+
+	// Callbacks registered with gsapi_set_poll and gsapi_set_stdio
+	static int OnPoll(void* CallerHandle);
+	static int OnStdin(void* CallerHandle, char* Buffer, int Length);
+	static int OnStdout(void* CallerHandle, const char* Str, int Length);
+	static int OnStderr(void* CallerHandle, const char* Str, int Length);
+};
+
+// Keeps warmed Ghostscript interpreters alive and feeds them new documents
+class FGhostscriptInstancePool
+{
+private:
+	// Owner of the Ghostscript function pointers
+	FGhostscriptRasterizer& Ghostscript;
+
+	// Instances waiting for the next document
+	TArray<TUniquePtr<FGhostscriptInstance>> IdleInstances;
+	FCriticalSection IdleInstancesLock;
+
+	// Maximum number of interpreters kept alive while idle
+	int MaxIdleInstances;
+
+	// Threads that render the shards of parallel renders besides the calling thread
+	// Renders block their thread for the whole shard, so they are kept off the task graph and the shared thread pool
+	class FQueuedThreadPool* ShardThreadPool;
+
+public:
+	// Number of pages per shard when the last page is not known
+	static const int DefaultPagesPerShard;
+
+public:
+	// Constructor
+	FGhostscriptInstancePool(FGhostscriptRasterizer& InGhostscript);
+
+	// Destructor
+	~FGhostscriptInstancePool();
+
+	// Get the number of pages in PDF with a pooled interpreter, or -1 on failure
+	int GetPageCount(const FString& InputPath);
+
+	// Read the page count, page boxes and document information of PDF with a pooled interpreter without rendering
+	bool ProbePdf(const FString& InputPath, FPDFDocumentInfo& OutInfo);
+
+	// Render the pages of PDF into memory with a pooled interpreter
+	bool StreamPdfToBitmap(const FString& InputPath, int Dpi, int FirstPage, int LastPage, const FPDFPageRenderedCallback& OnPageRendered, const FPDFConversionToken* Token, const FPDFPageBufferAllocator& AllocatePageBuffer = FPDFPageBufferAllocator());
+
+	// Split the page range into shards and render them concurrently on multiple pooled interpreters
+	// The page count is read first when the range is not known, and no more workers than pages are used
+	bool StreamPdfToBitmapParallel(const FString& InputPath, int Dpi, int FirstPage, int LastPage, int NumWorkers, const FPDFPageRenderedCallback& OnPageRendered, const FPDFConversionToken* Token, const FPDFPageBufferAllocator& AllocatePageBuffer = FPDFPageBufferAllocator());
+
+	// Create interpreters in advance so that the first document does not pay for startup
+	void Prewarm(int NumInstances);
+
+	// Shut down all idle interpreters
+	void Empty();
+
+private:
+	// Render the pages in the range with the interpreter, numbering them from PageIndexOffset
+	bool RenderPages(FGhostscriptInstance& Instance, const FString& InputPath, int Dpi, const struct FGhostscriptRenderBudget& Budget, int FirstPage, int LastPage, int PageIndexOffset, const FPDFPageRenderedCallback& OnPageRendered, const FPDFConversionToken* Token, const FPDFPageBufferAllocator& AllocatePageBuffer, int& OutNumPages);
+
+	// Run the PostScript program that reads the input file with the interpreter
+	bool RunProgram(FGhostscriptInstance& Instance, const FString& InputPath, const FString& Program);
+
+	// Take out an idle interpreter or create a new one
+	TUniquePtr<FGhostscriptInstance> Acquire();
+
+	// Return the interpreter to the pool, or shut it down if it can no longer be used
+	void Release(TUniquePtr<FGhostscriptInstance> Instance, bool bIsReusable);
+
+	// Create and initialize a new interpreter, with the arguments of the pool followed by ExtraArguments
+	TUniquePtr<FGhostscriptInstance> CreateInstance(const TArray<FString>& ExtraArguments = TArray<FString>());
+
+	// Shut down the interpreter
+	void DestroyInstance(TUniquePtr<FGhostscriptInstance> Instance);
+
+	// Make a PostScript string literal from text
+	static FString EscapePostScriptString(const FString& Text);
+
+	// Decode a PDF text string, which is UTF-16BE or UTF-8 with a byte order mark, or PDFDocEncoding
+	static FString DecodePDFTextString(const TArray<uint8>& Bytes);
+
+private:
+	friend class FGhostscriptTileRenderer;
+};
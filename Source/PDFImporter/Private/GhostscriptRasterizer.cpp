@@ -0,0 +1,689 @@
+#include "GhostscriptRasterizer.h"
+#include "GhostscriptDisplay.h"
+#include "GhostscriptInstancePool.h"
+#include "GenericPlatform/GenericPlatformProcess.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformMisc.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/ScopeExit.h"
+#include "Misc/ScopeLock.h"
+#include "Misc/Parse.h"
+#include "PDFImporterSettings.h"
+#include "PDFConversionToken.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/WindowsGhostscriptRasterizer.h"
+#elif PLATFORM_LINUX
+#include "Linux/LinuxGhostscriptRasterizer.h"
+#endif
+
+static TAutoConsoleVariable<int32> CVarRenderWorkers(
+	TEXT("PDFImporter.RenderWorkers"),
+	0,
+	TEXT("Number of Ghostscript interpreters that render the pages of one document concurrently.\n")
+	TEXT("0: Auto (one per NumRenderingThreads cores)"),
+	ECVF_Default
+);
+
+// 自動で決めるMaxBitmapの下限
+static const int64 MinAutoMaxBitmap = 16 * 1024 * 1024;
+
+// MaxBitmapに使ってよい空き物理メモリの割合
+static const int64 MaxBitmapMemoryDivisor = 4;
+
+// タイルピラミッドごとに次のタイルを待たせておくインタプリタの数
+static const int MaxIdleTileInstances = 4;
+
+TSharedPtr<FGhostscriptRasterizer, ESPMode::ThreadSafe> FGhostscriptRasterizer::Create()
+{
+	TSharedPtr<FGhostscriptRasterizer, ESPMode::ThreadSafe> Rasterizer;
+#if PLATFORM_WINDOWS
+	Rasterizer = MakeShareable(new FWindowsGhostscriptRasterizer());
+#elif PLATFORM_LINUX
+	Rasterizer = MakeShareable(new FLinuxGhostscriptRasterizer());
+#endif
+
+	if (!Rasterizer.IsValid())
+	{
+		UE_LOG(PDFImporter, Error, TEXT("Ghostscript is not supported on this platform"));
+		return nullptr;
+	}
+
+	if (!Rasterizer->LoadGhostscriptLibrary())
+	{
+		return nullptr;
+	}
+
+	return Rasterizer;
+}
+
+FGhostscriptRasterizer::FGhostscriptRasterizer()
+	: GhostscriptModule(nullptr)
+	, CreateInstance(nullptr), DeleteInstance(nullptr), Init(nullptr), Exit(nullptr)
+	, SetDisplayCallback(nullptr), RunString(nullptr), AddControlPath(nullptr), RemoveControlPath(nullptr)
+	, SetPoll(nullptr), SetStdio(nullptr), Revision(0)
+{
+}
+
+FGhostscriptRasterizer::~FGhostscriptRasterizer()
+{
+	// ライブラリを解放する前にインタプリタを終了させる
+	InstancePool.Reset();
+
+	if (GhostscriptModule != nullptr)
+	{
+		FPlatformProcess::FreeDllHandle(GhostscriptModule);
+		UE_LOG(PDFImporter, Log, TEXT("Ghostscript library unloaded"));
+	}
+}
+
+bool FGhostscriptRasterizer::LoadGhostscriptLibrary()
+{
+	// モジュールをロード
+	FString LoadedPath;
+	for (const FString& LibraryPath : GetLibraryPaths())
+	{
+		GhostscriptModule = FPlatformProcess::GetDllHandle(*LibraryPath);
+		if (GhostscriptModule != nullptr)
+		{
+			LoadedPath = LibraryPath;
+			break;
+		}
+	}
+
+	if (GhostscriptModule == nullptr)
+	{
+		UE_LOG(PDFImporter, Error, TEXT("Failed to load Ghostscript module"));
+		return false;
+	}
+
+	// 関数ポインタを取得
+	CreateInstance = (CreateAPIInstance)FPlatformProcess::GetDllExport(GhostscriptModule, TEXT("gsapi_new_instance"));
+	DeleteInstance = (DeleteAPIInstance)FPlatformProcess::GetDllExport(GhostscriptModule, TEXT("gsapi_delete_instance"));
+	Init = (InitAPI)FPlatformProcess::GetDllExport(GhostscriptModule, TEXT("gsapi_init_with_args"));
+	Exit = (ExitAPI)FPlatformProcess::GetDllExport(GhostscriptModule, TEXT("gsapi_exit"));
+	SetDisplayCallback = (SetDisplayCallbackAPI)FPlatformProcess::GetDllExport(GhostscriptModule, TEXT("gsapi_set_display_callback"));
+	if (CreateInstance == nullptr || DeleteInstance == nullptr || Init == nullptr || Exit == nullptr || SetDisplayCallback == nullptr)
+	{
+		UE_LOG(PDFImporter, Error, TEXT("Failed to get Ghostscript function pointer"));
+		return false;
+	}
+
+	// インスタンスの使い回しに使う関数は古いGhostscriptには無いことがある
+	RunString = (RunStringAPI)FPlatformProcess::GetDllExport(GhostscriptModule, TEXT("gsapi_run_string"));
+	AddControlPath = (ControlPathAPI)FPlatformProcess::GetDllExport(GhostscriptModule, TEXT("gsapi_add_control_path"));
+	RemoveControlPath = (ControlPathAPI)FPlatformProcess::GetDllExport(GhostscriptModule, TEXT("gsapi_remove_control_path"));
+
+	// キャンセルと出力の取得に使う関数
+	SetPoll = (SetPollAPI)FPlatformProcess::GetDllExport(GhostscriptModule, TEXT("gsapi_set_poll"));
+	SetStdio = (SetStdioAPI)FPlatformProcess::GetDllExport(GhostscriptModule, TEXT("gsapi_set_stdio"));
+	InstancePool = MakeUnique<FGhostscriptInstancePool>(*this);
+
+	// 表示デバイスにページごとのメモリを渡せるかはリビジョンで判断する
+	RevisionAPI GetRevision = (RevisionAPI)FPlatformProcess::GetDllExport(GhostscriptModule, TEXT("gsapi_revision"));
+	FGhostscriptRevision RevisionInfo;
+	if (GetRevision != nullptr && GetRevision(&RevisionInfo, sizeof(RevisionInfo)) == 0)
+	{
+		Revision = (int)RevisionInfo.Revision;
+	}
+
+	UE_LOG(PDFImporter, Log, TEXT("Ghostscript library loaded (%s, revision %d)"), *LoadedPath, Revision);
+	return true;
+}
+
+int FGhostscriptRasterizer::GetPageCount(const FString& InputPath)
+{
+	// ページ数を調べるには起動済みのインタプリタでPostScriptを実行する必要がある
+	if (RunString == nullptr || SetStdio == nullptr)
+	{
+		return -1;
+	}
+
+	return InstancePool->GetPageCount(InputPath);
+}
+
+bool FGhostscriptRasterizer::ProbePdf(const FString& InputPath, FPDFDocumentInfo& OutInfo)
+{
+	// 出力デバイスを使わずに起動済みのインタプリタでPostScriptを実行する
+	if (RunString == nullptr || SetStdio == nullptr)
+	{
+		return false;
+	}
+
+	return InstancePool->ProbePdf(InputPath, OutInfo);
+}
+
+bool FGhostscriptRasterizer::StreamPdfToBitmap(const FString& InputPath, int Dpi, int FirstPage, int LastPage, const FPDFPageRenderedCallback& OnPageRendered, const FPDFConversionToken* Token, const FPDFPageBufferAllocator& AllocatePageBuffer)
+{
+	return StreamPdfToBitmap(InputPath, Dpi, FirstPage, LastPage, OnPageRendered, Token, true, AllocatePageBuffer);
+}
+
+bool FGhostscriptRasterizer::ConvertPdfToImageFiles(const FString& InputPath, const FString& OutputPath, const FString& Device, int Dpi, int FirstPage, int LastPage, const FPDFConversionToken* Token)
+{
+	NumActiveJobs.Increment();
+	ON_SCOPE_EXIT { NumActiveJobs.Decrement(); };
+
+	TArray<FString> Arguments = MakeRenderArguments(Dpi, FirstPage, LastPage);
+	Arguments.Add(TEXT("-sDEVICE=") + Device);				// 出力形式
+	Arguments.Add(TEXT("-sOutputFile=") + OutputPath);		// 出力パス
+	Arguments.Add(InputPath);								// 入力パス
+
+	FGhostscriptInstance Instance;
+	Instance.Token = Token;
+	return RunGhostscript(Arguments, Instance, false);
+}
+
+bool FGhostscriptRasterizer::ExtractText(const FString& InputPath, int FirstPage, int LastPage, TArray<FPDFTextIndex::FWord>& OutWords, const FPDFConversionToken* Token)
+{
+	NumActiveJobs.Increment();
+	ON_SCOPE_EXIT { NumActiveJobs.Decrement(); };
+
+	// 72dpiで描画して座標をポイント単位にし、文字ごとの位置を含む形式で標準出力に書き出させる
+	TArray<FString> Arguments = MakeRenderArguments(72, FirstPage, LastPage);
+	Arguments.Add(TEXT("-sDEVICE=txtwrite"));		// テキストを出力
+	Arguments.Add(TEXT("-dTextFormat=0"));			// 文字ごとの位置を含むXML
+	Arguments.Add(TEXT("-sOutputFile=-"));			// 標準出力に出力
+	Arguments.Add(InputPath);						// 入力パス
+
+	FGhostscriptInstance Instance;
+	Instance.Token = Token;
+	if (!RunGhostscript(Arguments, Instance, false))
+	{
+		return false;
+	}
+
+	ParseTxtwriteOutput(Instance.TakeOutput(), OutWords);
+	UE_LOG(PDFImporter, Log, TEXT("Extracted %d words from %s"), OutWords.Num(), *InputPath);
+	return true;
+}
+
+bool FGhostscriptRasterizer::StreamPdfToBitmap(const FString& InputPath, int Dpi, int FirstPage, int LastPage, const FPDFPageRenderedCallback& OnPageRendered, const FPDFConversionToken* Token, bool bUseInstancePool, const FPDFPageBufferAllocator& AllocatePageBuffer)
+{
+	NumActiveJobs.Increment();
+	ON_SCOPE_EXIT { NumActiveJobs.Decrement(); };
+
+	// 起動済みのインタプリタを使い回す
+	if (bUseInstancePool && RunString != nullptr)
+	{
+		return InstancePool->StreamPdfToBitmapParallel(InputPath, Dpi, FirstPage, LastPage, GetNumRenderWorkers(), OnPageRendered, Token, AllocatePageBuffer);
+	}
+
+	FGhostscriptInstance Instance;
+	Instance.Token = Token;
+	int NumPages = 0;
+	Instance.Display.SetPageHandler([&OnPageRendered, &NumPages](FPDFPageBitmap& Page)
+	{
+		OnPageRendered(NumPages++, Page);
+	});
+	Instance.Display.SetPageAllocator(AllocatePageBuffer);
+
+	TArray<FString> Arguments = MakeRenderArguments(Dpi, FirstPage, LastPage);
+	Arguments.Add(TEXT("-sDEVICE=display"));												// コールバックに出力
+	Arguments.Add(FString::Printf(TEXT("-dDisplayFormat=%d"), GS_DISPLAY_FORMAT_BGRA));	// BGRAで出力
+	Arguments.Add(Instance.Display.GetHandleArgument());									// コールバックに渡すハンドル
+	Arguments.Add(InputPath);																// 入力パス
+
+	return RunGhostscript(Arguments, Instance, true);
+}
+
+// タイルピラミッドの間インタプリタにドキュメントを開かせたままにして、タイルごとに起動や解析をし直さないようにする
+// 解像度と出力の大きさは初期化の引数で固定されるので、インタプリタはその組み合わせごとに使い分ける
+class FGhostscriptTileRenderer : public IPDFTileRenderer
+{
+private:
+	struct FTileInstance
+	{
+		TUniquePtr<FGhostscriptInstance> Instance;
+		int Dpi;
+		FIntPoint Size;
+
+		FTileInstance() : Dpi(0), Size(FIntPoint::ZeroValue) {}
+	};
+
+	// インタプリタを終了させるまでライブラリを解放させない
+	TSharedRef<FGhostscriptRasterizer, ESPMode::ThreadSafe> Ghostscript;
+	FString InputPath;
+
+	// ドキュメントを開いたまま次のタイルを待っているインタプリタ（古い順）
+	TArray<FTileInstance> IdleInstances;
+	FCriticalSection IdleInstancesLock;
+
+public:
+	FGhostscriptTileRenderer(TSharedRef<FGhostscriptRasterizer, ESPMode::ThreadSafe> InGhostscript, const FString& InInputPath)
+		: Ghostscript(InGhostscript), InputPath(InInputPath)
+	{
+	}
+
+	virtual ~FGhostscriptTileRenderer()
+	{
+		for (FTileInstance& Tile : IdleInstances)
+		{
+			Ghostscript->InstancePool->DestroyInstance(MoveTemp(Tile.Instance));
+		}
+	}
+
+	virtual bool RenderTile(int Page, int Dpi, const FIntRect& Region, const FIntPoint& PageSize, FPDFPageBitmap& OutTile, const FPDFConversionToken* Token) override
+	{
+		if (Token != nullptr && Token->IsCanceled())
+		{
+			return false;
+		}
+
+		Ghostscript->NumActiveJobs.Increment();
+		ON_SCOPE_EXIT { Ghostscript->NumActiveJobs.Decrement(); };
+
+		FTileInstance Tile = Acquire(Dpi, FIntPoint(FMath::Max(Region.Width(), 1), FMath::Max(Region.Height(), 1)));
+		if (!Tile.Instance.IsValid())
+		{
+			return false;
+		}
+
+		// 出力はタイルの大きさに固定されているので、ページの原点（左下）をずらしてタイルの範囲を出力に収める
+		const float PixelsToPoints = 72.0f / Dpi;
+		const FString Program = FString::Printf(TEXT("<< /Install {%f %f translate} >> setpagedevice %d %d dopdfpages"),
+			-Region.Min.X * PixelsToPoints, (Tile.Size.Y + Region.Min.Y - PageSize.Y) * PixelsToPoints, Page, Page
+		);
+
+		bool bIsRendered = false;
+		Tile.Instance->Display.SetPageHandler([&OutTile, &bIsRendered](FPDFPageBitmap& Bitmap)
+		{
+			OutTile = MoveTemp(Bitmap);
+			bIsRendered = true;
+		});
+
+		Tile.Instance->Token = Token;
+		const bool bIsSucceeded = Ghostscript->InstancePool->RunProgram(*Tile.Instance, InputPath, Program);
+		Tile.Instance->Token = nullptr;
+		Tile.Instance->Display.DiscardPendingPage();
+		Tile.Instance->Display.SetPageHandler(nullptr);
+
+		// エラーや中断で止まったインタプリタはドキュメントの状態が分からないので再利用しない
+		Release(MoveTemp(Tile), bIsSucceeded);
+		return bIsSucceeded && bIsRendered;
+	}
+
+private:
+	// 同じ解像度と大きさのインタプリタを取り出すか、新しく作ってドキュメントを開かせる
+	FTileInstance Acquire(int Dpi, const FIntPoint& Size)
+	{
+		{
+			FScopeLock Lock(&IdleInstancesLock);
+			for (int Index = IdleInstances.Num() - 1; Index >= 0; --Index)
+			{
+				if (IdleInstances[Index].Dpi == Dpi && IdleInstances[Index].Size == Size)
+				{
+					FTileInstance Tile = MoveTemp(IdleInstances[Index]);
+					IdleInstances.RemoveAt(Index);
+					return Tile;
+				}
+			}
+		}
+
+		const FGhostscriptRenderBudget Budget = Ghostscript->MakeRenderBudget(Dpi, 1);
+
+		FTileInstance Tile;
+		Tile.Dpi = Dpi;
+		Tile.Size = Size;
+		Tile.Instance = Ghostscript->InstancePool->CreateInstance(
+		{
+			TEXT("-dMaxBitmap=") + LexToString(Budget.MaxBitmap),							// パフォーマンスを向上させる
+			TEXT("-dNumRenderingThreads=") + FString::FromInt(Budget.NumRenderingThreads),	// マルチコアで実行
+			TEXT("-dDEVICEXRESOLUTION=") + FString::FromInt(Dpi),							// 横のDPI
+			TEXT("-dDEVICEYRESOLUTION=") + FString::FromInt(Dpi),							// 縦のDPI
+			FString::Printf(TEXT("-g%dx%d"), Size.X, Size.Y),								// 出力の大きさ
+			TEXT("-dFIXEDMEDIA"),															// ページの大きさで出力を変えない
+		});
+		if (!Tile.Instance.IsValid())
+		{
+			return Tile;
+		}
+
+		// ドキュメントを開いたままにして、タイルごとにページだけを描画させる
+		const FString Program = FGhostscriptInstancePool::EscapePostScriptString(InputPath) + TEXT(" (r) file runpdfbegin process_trailer_attrs");
+		if (!Ghostscript->InstancePool->RunProgram(*Tile.Instance, InputPath, Program))
+		{
+			UE_LOG(PDFImporter, Error, TEXT("Ghostscript failed to open %s for tiles"), *InputPath);
+			Ghostscript->InstancePool->DestroyInstance(MoveTemp(Tile.Instance));
+		}
+
+		return Tile;
+	}
+
+	// インタプリタを次のタイルまで残すか、使えなくなったものを終了させる
+	void Release(FTileInstance Tile, bool bIsReusable)
+	{
+		TUniquePtr<FGhostscriptInstance> InstanceToDestroy;
+		if (bIsReusable)
+		{
+			FScopeLock Lock(&IdleInstancesLock);
+			IdleInstances.Add(MoveTemp(Tile));
+
+			// ズームで使われなくなった解像度のものから終了させる
+			if (IdleInstances.Num() > MaxIdleTileInstances)
+			{
+				InstanceToDestroy = MoveTemp(IdleInstances[0].Instance);
+				IdleInstances.RemoveAt(0);
+			}
+		}
+		else
+		{
+			InstanceToDestroy = MoveTemp(Tile.Instance);
+		}
+
+		if (InstanceToDestroy.IsValid())
+		{
+			Ghostscript->InstancePool->DestroyInstance(MoveTemp(InstanceToDestroy));
+		}
+	}
+};
+
+TSharedPtr<IPDFTileRenderer, ESPMode::ThreadSafe> FGhostscriptRasterizer::OpenTileRenderer(const FString& InputPath)
+{
+	// 開いたドキュメントにタイルごとのプログラムを続けて実行させる
+	if (RunString == nullptr)
+	{
+		UE_LOG(PDFImporter, Error, TEXT("Tiles require gsapi_run_string, which this Ghostscript does not export"));
+		return nullptr;
+	}
+
+	return MakeShared<FGhostscriptTileRenderer, ESPMode::ThreadSafe>(StaticCastSharedRef<FGhostscriptRasterizer>(AsShared()), InputPath);
+}
+
+void FGhostscriptRasterizer::ParseTxtwriteOutput(const FString& Output, TArray<FPDFTextIndex::FWord>& OutWords)
+{
+	// 属性の値を取得
+	auto GetAttribute = [](const FString& Line, const TCHAR* Name, FString& OutValue)
+	{
+		const FString Prefix = FString(Name) + TEXT("=\"");
+		const int32 Start = Line.Find(Prefix, ESearchCase::CaseSensitive);
+		if (Start == INDEX_NONE)
+		{
+			return false;
+		}
+
+		const int32 ValueStart = Start + Prefix.Len();
+		const int32 End = Line.Find(TEXT("\""), ESearchCase::CaseSensitive, ESearchDir::FromStart, ValueStart);
+		if (End == INDEX_NONE)
+		{
+			return false;
+		}
+
+		OutValue = Line.Mid(ValueStart, End - ValueStart);
+		return true;
+	};
+
+	// 文字参照の符号位置を追加する（TCHARがUTF-16の場合、基本多言語面の外の文字はサロゲートペアにする）
+	auto AppendCodePoint = [](FString& Text, uint64 CodePoint)
+	{
+		if (CodePoint == 0 || CodePoint > 0x10FFFF)
+		{
+			return;
+		}
+
+		if (sizeof(TCHAR) == 2 && CodePoint > 0xFFFF)
+		{
+			CodePoint -= 0x10000;
+			Text.AppendChar((TCHAR)(0xD800 + (CodePoint >> 10)));
+			Text.AppendChar((TCHAR)(0xDC00 + (CodePoint & 0x3FF)));
+		}
+		else
+		{
+			Text.AppendChar((TCHAR)CodePoint);
+		}
+	};
+
+	// 文字参照を文字に戻す
+	auto UnescapeXml = [&AppendCodePoint](const FString& Text)
+	{
+		FString Unescaped;
+		for (int32 Index = 0; Index < Text.Len(); ++Index)
+		{
+			const int32 End = (Text[Index] == TEXT('&')) ? Text.Find(TEXT(";"), ESearchCase::CaseSensitive, ESearchDir::FromStart, Index) : INDEX_NONE;
+			if (End == INDEX_NONE)
+			{
+				Unescaped.AppendChar(Text[Index]);
+				continue;
+			}
+
+			const FString Entity = Text.Mid(Index + 1, End - Index - 1);
+			if (Entity.StartsWith(TEXT("#x")))
+			{
+				AppendCodePoint(Unescaped, FParse::HexNumber64(*Entity.Mid(2)));
+			}
+			else if (Entity.StartsWith(TEXT("#")))
+			{
+				AppendCodePoint(Unescaped, (uint64)FMath::Max<int64>(FCString::Atoi64(*Entity.Mid(1)), 0));
+			}
+			else if (Entity == TEXT("amp")) { Unescaped.AppendChar(TEXT('&')); }
+			else if (Entity == TEXT("lt")) { Unescaped.AppendChar(TEXT('<')); }
+			else if (Entity == TEXT("gt")) { Unescaped.AppendChar(TEXT('>')); }
+			else if (Entity == TEXT("quot")) { Unescaped.AppendChar(TEXT('"')); }
+			else if (Entity == TEXT("apos")) { Unescaped.AppendChar(TEXT('\'')); }
+			Index = End;
+		}
+		return Unescaped;
+	};
+
+	// <page>ごとに<span>内の<char>を空白で区切って単語にする
+	FPDFTextIndex::FWord Word;
+	Word.Page = 0;
+	auto FlushWord = [&OutWords, &Word]()
+	{
+		if (!Word.Text.IsEmpty())
+		{
+			OutWords.Add(Word);
+		}
+		Word.Text.Empty();
+		Word.Box = FBox2D(ForceInit);
+	};
+	FlushWord();
+
+	TArray<FString> Lines;
+	Output.ParseIntoArrayLines(Lines);
+	for (const FString& Line : Lines)
+	{
+		const FString Trimmed = Line.TrimStart();
+		if (Trimmed.StartsWith(TEXT("<page")))
+		{
+			FlushWord();
+			++Word.Page;
+		}
+		else if (Trimmed.StartsWith(TEXT("<span")) || Trimmed.StartsWith(TEXT("</span")))
+		{
+			FlushWord();
+		}
+		else if (Trimmed.StartsWith(TEXT("<char")))
+		{
+			FString BoxValue;
+			FString CharValue;
+			if (!GetAttribute(Trimmed, TEXT("bbox"), BoxValue) || !GetAttribute(Trimmed, TEXT("c"), CharValue))
+			{
+				continue;
+			}
+
+			const FString Char = UnescapeXml(CharValue);
+			if (Char.IsEmpty() || FChar::IsWhitespace(Char[0]))
+			{
+				FlushWord();
+				continue;
+			}
+
+			TArray<FString> Values;
+			BoxValue.ParseIntoArrayWS(Values);
+			if (Values.Num() == 4)
+			{
+				const FVector2D A(FCString::Atof(*Values[0]), FCString::Atof(*Values[1]));
+				const FVector2D B(FCString::Atof(*Values[2]), FCString::Atof(*Values[3]));
+				Word.Box += FBox2D(FVector2D::Min(A, B), FVector2D::Max(A, B));
+			}
+			Word.Text += Char;
+		}
+	}
+	FlushWord();
+}
+
+int FGhostscriptRasterizer::GetNumRenderWorkers() const
+{
+	const int NumRenderWorkers = CVarRenderWorkers.GetValueOnAnyThread();
+	return (NumRenderWorkers > 0) ? NumRenderWorkers : GetDefaultNumRenderWorkers();
+}
+
+int FGhostscriptRasterizer::GetDefaultNumRenderWorkers()
+{
+	// 各インタプリタが4スレッド程度で描画できるようにワーカー数を決める
+	return FMath::Max(FPlatformMisc::NumberOfCoresIncludingHyperthreads() / 4, 1);
+}
+
+FGhostscriptRenderBudget FGhostscriptRasterizer::MakeRenderBudget(int Dpi, int NumInterpreters) const
+{
+	const UPDFImporterSettings* Settings = GetDefault<UPDFImporterSettings>();
+	const int NumRenderers = FMath::Max(NumActiveJobs.GetValue(), 1) * FMath::Max(NumInterpreters, 1);
+
+	FGhostscriptRenderBudget Budget;
+
+	// 同時に描画しているインタプリタでコアを分け合う
+	if (Settings->NumRenderingThreads > 0)
+	{
+		Budget.NumRenderingThreads = Settings->NumRenderingThreads;
+	}
+	else
+	{
+		Budget.NumRenderingThreads = FMath::Max(FPlatformMisc::NumberOfCoresIncludingHyperthreads() / NumRenderers, 1);
+	}
+
+	// A3のページが分割せずに収まるサイズを、空きメモリを分け合える範囲で確保する
+	if (Settings->MaxBitmapMegabytes > 0)
+	{
+		Budget.MaxBitmap = (int64)Settings->MaxBitmapMegabytes * 1024 * 1024;
+	}
+	else
+	{
+		const int64 PageBytes = (int64)(11.69 * Dpi) * (int64)(16.54 * Dpi) * 4;
+		const int64 MemoryBudget = (int64)FPlatformMemory::GetStats().AvailablePhysical / MaxBitmapMemoryDivisor / NumRenderers;
+		Budget.MaxBitmap = FMath::Max(FMath::Min(PageBytes, MemoryBudget), MinAutoMaxBitmap);
+	}
+
+	UE_LOG(PDFImporter, Verbose, TEXT("Ghostscript render budget : %d threads, %lld bytes (%d dpi, %d renderers)"), Budget.NumRenderingThreads, Budget.MaxBitmap, Dpi, NumRenderers);
+	return Budget;
+}
+
+TArray<FString> FGhostscriptRasterizer::MakeCommonArguments() const
+{
+	return TArray<FString>
+	{
+		// Ghostscriptが標準出力に情報を出力しないように
+		TEXT("-q"),
+		TEXT("-dQUIET"),
+
+		TEXT("-dPARANOIDSAFER"),			// セーフモードで実行
+		TEXT("-dNOPAUSE"),					// ページごとの一時停止をしないように
+		TEXT("-dNOPROMPT"),					// コマンドプロンプトがでないように           
+
+		// 出力画像のアンチエイリアスや解像度など
+		TEXT("-dAlignToPixels=0"),
+		TEXT("-dGridFitTT=0"),
+		TEXT("-dTextAlphaBits=4"),
+		TEXT("-dGraphicsAlphaBits=4"),
+
+		// 各ページを固定の用紙ではなくそのページのCropBoxの大きさで描画する
+		TEXT("-dUseCropBox"),
+	};
+}
+
+TArray<FString> FGhostscriptRasterizer::MakeRenderArguments(int Dpi, int FirstPage, int LastPage) const
+{
+	if (!(FirstPage > 0 && LastPage > 0 && FirstPage <= LastPage))
+	{
+		FirstPage = 1;
+		LastPage = INT_MAX;
+	}
+
+	const FGhostscriptRenderBudget Budget = MakeRenderBudget(Dpi, 1);
+
+	TArray<FString> Arguments = MakeCommonArguments();
+	Arguments.Append(
+	{
+		TEXT("-dMaxBitmap=") + LexToString(Budget.MaxBitmap),							// パフォーマンスを向上させる
+		TEXT("-dNumRenderingThreads=") + FString::FromInt(Budget.NumRenderingThreads),	// マルチコアで実行
+		TEXT("-dBATCH"),												// Ghostscriptがインタラクティブモードにならないように
+		TEXT("-dFirstPage=") + FString::FromInt(FirstPage),				// 始めのページを指定
+		TEXT("-dLastPage=") + FString::FromInt(LastPage),				// 終わりのページを指定
+		TEXT("-dDEVICEXRESOLUTION=") + FString::FromInt(Dpi),			// 横のDPI
+		TEXT("-dDEVICEYRESOLUTION=") + FString::FromInt(Dpi),			// 縦のDPI
+	});
+
+	return Arguments;
+}
+
+bool FGhostscriptRasterizer::CreateGhostscriptInstance(FGhostscriptInstance& Instance, bool bUseDisplay)
+{
+	// コールバックで使うハンドルとしてインスタンスを渡す
+	CreateInstance(&Instance.Instance, &Instance);
+	if (Instance.Instance == nullptr)
+	{
+		UE_LOG(PDFImporter, Error, TEXT("Failed to create Ghostscript instance"));
+		return false;
+	}
+
+	// 出力先のコールバックを登録
+	// 対応していればページをGhostscriptのフレームバッファを経由せずに描画先のメモリへ直接描画させる
+	Instance.Display.SetRectangleRequest(Revision >= GS_DISPLAY_V3_REVISION);
+	if (bUseDisplay && SetDisplayCallback(Instance.Instance, Instance.Display.GetCallback()) != 0)
+	{
+		UE_LOG(PDFImporter, Error, TEXT("Failed to set Ghostscript display callback"));
+		DeleteInstance(Instance.Instance);
+		Instance.Instance = nullptr;
+		return false;
+	}
+
+	// キャンセルを確認するコールバックと標準入出力を登録
+	if (SetPoll != nullptr)
+	{
+		SetPoll(Instance.Instance, &FGhostscriptInstance::OnPoll);
+	}
+	if (SetStdio != nullptr)
+	{
+		SetStdio(Instance.Instance, &FGhostscriptInstance::OnStdin, &FGhostscriptInstance::OnStdout, &FGhostscriptInstance::OnStderr);
+	}
+
+	return true;
+}
+
+bool FGhostscriptRasterizer::RunGhostscript(const TArray<FString>& Arguments, FGhostscriptInstance& Instance, bool bUseDisplay)
+{
+	// 引数をマルチバイト文字列に変換
+	TArray<TArray<char>> ArgumentBuffers;
+	TArray<char*> Args;
+	for (const FString& Argument : Arguments)
+	{
+		ArgumentBuffers.Add(FStringToCharPtr(Argument));
+	}
+	for (TArray<char>& ArgumentBuffer : ArgumentBuffers)
+	{
+		Args.Add(ArgumentBuffer.GetData());
+	}
+
+	// Ghostscriptのインスタンスを作成
+	if (!CreateGhostscriptInstance(Instance, bUseDisplay))
+	{
+		return false;
+	}
+
+	// Ghostscriptを実行
+	int Result = Init(Instance.Instance, Args.Num(), Args.GetData());
+
+	// Ghostscriptを終了
+	Exit(Instance.Instance);
+	DeleteInstance(Instance.Instance);
+	Instance.Instance = nullptr;
+
+	if (Instance.Token != nullptr && Instance.Token->IsCanceled())
+	{
+		UE_LOG(PDFImporter, Log, TEXT("Ghostscript conversion canceled"));
+		return false;
+	}
+
+	UE_LOG(PDFImporter, Log, TEXT("Ghostscript Return Code : %d"), Result);
+
+	return Result == 0;
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PDFImporter.h"
+#include "IPDFRasterizer.h"
+#include "PDFTextIndex.h"
+#include "HAL/ThreadSafeCounter.h"
+
+typedef int(*CreateAPIInstance)(void** Instance, void* CallerHandle);
+typedef void(*DeleteAPIInstance)(void* Instance);
+typedef int(*InitAPI)(void* Instance, int Argc, char** Argv);
+typedef int(*ExitAPI)(void* Instance);
+typedef int(*SetDisplayCallbackAPI)(void* Instance, struct FGhostscriptDisplayCallback* Callback);
+typedef int(*RunStringAPI)(void* Instance, const char* Str, int UserErrors, int* ExitCode);
+typedef int(*ControlPathAPI)(void* Instance, int Type, const char* Path);
+typedef int(*SetPollAPI)(void* Instance, int(*PollCallback)(void* CallerHandle));
+typedef int(*RevisionAPI)(struct FGhostscriptRevision* Revision, int Length);
+typedef int(*SetStdioAPI)(void* Instance, int(*StdinCallback)(void* CallerHandle, char* Buffer, int Length), int(*StdoutCallback)(void* CallerHandle, const char* Str, int Length), int(*StderrCallback)(void* CallerHandle, const char* Str, int Length));
+
+// Version information filled by gsapi_revision (gsapi_revision_t)
+struct FGhostscriptRevision
+{
+	const char* Product;
+	const char* Copyright;
+	long Revision;
+	long RevisionDate;
+};
+
+// Resources given to each Ghostscript interpreter of a job
+struct FGhostscriptRenderBudget
+{
+	// Value of -dNumRenderingThreads
+	int NumRenderingThreads;
+
+	// Value of -dMaxBitmap in bytes
+	int64 MaxBitmap;
+
+	FGhostscriptRenderBudget() : NumRenderingThreads(1), MaxBitmap(0) {}
+};
+
+// Rasterizer backed by the Ghostscript shared library
+// Platform subclasses only decide where the library is and how strings are passed to it
+class FGhostscriptRasterizer : public IPDFRasterizer
+{
+private:
+	// Ghostscript module
+	void* GhostscriptModule;
+
+	// Ghostscript function pointers
+	CreateAPIInstance CreateInstance;
+	DeleteAPIInstance DeleteInstance;
+	InitAPI Init;
+	ExitAPI Exit;
+	SetDisplayCallbackAPI SetDisplayCallback;
+	RunStringAPI RunString;
+	ControlPathAPI AddControlPath;
+	ControlPathAPI RemoveControlPath;
+	SetPollAPI SetPoll;
+	SetStdioAPI SetStdio;
+
+	// Revision of the loaded library such as 953 for 9.53, or 0 if unknown
+	int Revision;
+
+	// Interpreters kept alive between conversions
+	TUniquePtr<class FGhostscriptInstancePool> InstancePool;
+
+	// Number of conversions currently running, which share the cores and memory
+	FThreadSafeCounter NumActiveJobs;
+
+public:
+	// Create the rasterizer for the running platform, or nullptr if Ghostscript is not available
+	static TSharedPtr<FGhostscriptRasterizer, ESPMode::ThreadSafe> Create();
+
+	// Destructor
+	virtual ~FGhostscriptRasterizer();
+
+	// IPDFRasterizer interface
+	virtual FName GetRasterizerName() const override { return FName(TEXT("Ghostscript")); }
+	virtual int GetPageCount(const FString& InputPath) override;
+	virtual bool StreamPdfToBitmap(const FString& InputPath, int Dpi, int FirstPage, int LastPage, const FPDFPageRenderedCallback& OnPageRendered, const FPDFConversionToken* Token, const FPDFPageBufferAllocator& AllocatePageBuffer = FPDFPageBufferAllocator()) override;
+	virtual TSharedPtr<IPDFTileRenderer, ESPMode::ThreadSafe> OpenTileRenderer(const FString& InputPath) override;
+	// End of IPDFRasterizer interface
+
+	// Read the page count, page boxes and document information of PDF without rendering
+	bool ProbePdf(const FString& InputPath, struct FPDFDocumentInfo& OutInfo);
+
+	// Convert PDF to BGRA bitmaps in memory using the Ghostscript display device
+	bool StreamPdfToBitmap(const FString& InputPath, int Dpi, int FirstPage, int LastPage, const FPDFPageRenderedCallback& OnPageRendered, const FPDFConversionToken* Token, bool bUseInstancePool, const FPDFPageBufferAllocator& AllocatePageBuffer = FPDFPageBufferAllocator());
+
+	// Extract the words of the pages with their boxes in points using the txtwrite device
+	bool ExtractText(const FString& InputPath, int FirstPage, int LastPage, TArray<FPDFTextIndex::FWord>& OutWords, const FPDFConversionToken* Token = nullptr);
+
+	// Convert PDF to multiple image files with the specified output device using Ghostscript API
+	bool ConvertPdfToImageFiles(const FString& InputPath, const FString& OutputPath, const FString& Device, int Dpi, int FirstPage, int LastPage, const FPDFConversionToken* Token = nullptr);
+
+	// Get the pool of interpreters kept alive between conversions
+	class FGhostscriptInstancePool& GetInstancePool() const { return *InstancePool; }
+
+protected:
+	// Constructor
+	FGhostscriptRasterizer();
+
+	// Get the candidate paths of the Ghostscript shared library in order of priority
+	virtual TArray<FString> GetLibraryPaths() const = 0;
+
+	// Convert text to the multibyte encoding Ghostscript expects on this platform
+	virtual TArray<char> FStringToCharPtr(const FString& Text) const = 0;
+
+private:
+	// Load the Ghostscript shared library and get the function pointers
+	bool LoadGhostscriptLibrary();
+
+	// Get the number of interpreters that render a document concurrently
+	int GetNumRenderWorkers() const;
+
+	// Get the number of workers that keeps all cores busy without oversubscribing them
+	static int GetDefaultNumRenderWorkers();
+
+	// Get the rendering threads and bitmap size for each of the interpreters rendering a job at the DPI
+	FGhostscriptRenderBudget MakeRenderBudget(int Dpi, int NumInterpreters) const;
+
+	// Split the characters written by txtwrite with -dTextFormat=0 into words
+	static void ParseTxtwriteOutput(const FString& Output, TArray<FPDFTextIndex::FWord>& OutWords);
+
+	// Get the arguments shared by one-shot and pooled interpreters
+	TArray<FString> MakeCommonArguments() const;
+
+	// Get the arguments common to all output devices
+	TArray<FString> MakeRenderArguments(int Dpi, int FirstPage, int LastPage) const;
+
+	// Create a Ghostscript instance and register the callbacks that receive the output and cancellation
+	bool CreateGhostscriptInstance(struct FGhostscriptInstance& Instance, bool bUseDisplay);
+
+	// Run Ghostscript with the specified arguments on a new instance
+	bool RunGhostscript(const TArray<FString>& Arguments, struct FGhostscriptInstance& Instance, bool bUseDisplay);
+
+private:
+	friend class FGhostscriptInstancePool;
+	friend class FGhostscriptTileRenderer;
+};
@@ -0,0 +1,26 @@
+#include "IPDFRasterizer.h"
+#include "Misc/ScopeLock.h"
+
+bool IPDFRasterizer::ConvertPdfToBitmap(const FString& InputPath, int Dpi, int FirstPage, int LastPage, TArray<FPDFPageBitmap>& OutPages, const FPDFConversionToken* Token)
+{
+	// 並列に描画されたページも順番通りに並べる
+	FCriticalSection PagesLock;
+	TArray<FPDFPageBitmap> Pages;
+	const bool bIsSucceeded = StreamPdfToBitmap(InputPath, Dpi, FirstPage, LastPage, [&Pages, &PagesLock](int PageIndex, FPDFPageBitmap& Page)
+	{
+		FScopeLock Lock(&PagesLock);
+		if (Pages.Num() <= PageIndex)
+		{
+			Pages.SetNum(PageIndex + 1);
+		}
+		Pages[PageIndex] = MoveTemp(Page);
+	}, Token);
+
+	if (!bIsSucceeded)
+	{
+		return false;
+	}
+
+	OutPages.Append(MoveTemp(Pages));
+	return true;
+}
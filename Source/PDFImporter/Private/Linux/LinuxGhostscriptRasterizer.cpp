@@ -0,0 +1,31 @@
+#include "Linux/LinuxGhostscriptRasterizer.h"
+
+#if PLATFORM_LINUX
+
+#include "Misc/Paths.h"
+
+TArray<FString> FLinuxGhostscriptRasterizer::GetLibraryPaths() const
+{
+	// プラグインに同梱されたものを優先し、無ければシステムにインストールされたものを使う
+	FString GhostscriptLibraryPath = FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectPluginsDir(), TEXT("PDFImporter"), TEXT("ThirdParty")));
+	GhostscriptLibraryPath = FPaths::Combine(GhostscriptLibraryPath, TEXT("Linux"), TEXT("libgs.so"));
+
+	return TArray<FString>
+	{
+		GhostscriptLibraryPath,
+		TEXT("libgs.so"),
+		TEXT("libgs.so.10"),
+		TEXT("libgs.so.9"),
+	};
+}
+
+TArray<char> FLinuxGhostscriptRasterizer::FStringToCharPtr(const FString& Text) const
+{
+	// Linux版のGhostscriptはUTF-8で受け取る
+	FTCHARToUTF8 Converted(*Text);
+	TArray<char> Buffer(Converted.Get(), Converted.Length() + 1);
+	Buffer[Converted.Length()] = '\0';
+	return Buffer;
+}
+
+#endif
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GhostscriptRasterizer.h"
+
+#if PLATFORM_LINUX
+
+// Ghostscript backend that loads libgs.so bundled with the plugin or installed on the system
+class FLinuxGhostscriptRasterizer : public FGhostscriptRasterizer
+{
+protected:
+	// FGhostscriptRasterizer interface
+	virtual TArray<FString> GetLibraryPaths() const override;
+	virtual TArray<char> FStringToCharPtr(const FString& Text) const override;
+	// End of FGhostscriptRasterizer interface
+};
+
+#endif
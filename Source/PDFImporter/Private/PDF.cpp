@@ -10,7 +10,12 @@
 #include "EditorFramework/AssetImportData.h"
 #endif
 
-static const int PDF_Version = 1;
+// 1: 初期バージョン、2: ページごとのピクセルサイズを追加、3: テキストの検索インデックスを追加、4: ページの指紋を追加
+static const int PDF_Version_Initial = 1;
+static const int PDF_Version_PageSizes = 2;
+static const int PDF_Version_TextIndex = 3;
+static const int PDF_Version_PageFingerprints = 4;
+static const int PDF_Version = PDF_Version_PageFingerprints;
 static const FGuid PDF_GUID(2020, 1, 13, 16);
 static FCustomVersionRegistration RegisterPDFCustomVersion(PDF_GUID, PDF_Version, TEXT("PDFVersion"));
 
@@ -30,15 +35,53 @@ UTexture2D* UPDF::GetPageTexture(int Page) const
 	return Pages[Page - 1];
 }
 
+FIntPoint UPDF::GetPageSize(int Page) const
+{
+	if (Page < 1 || Page > PageSizes.Num())
+	{
+		UE_LOG(PDFImporter, Warning, TEXT("The specified page is out of the range of the PDF"));
+		return FIntPoint::ZeroValue;
+	}
+
+	return PageSizes[Page - 1];
+}
+
+TArray<FPDFTextMatch> UPDF::FindText(const FString& Query) const
+{
+	// インデックスの座標はポイント単位なのでテクスチャの解像度に合わせる
+	return TextIndex.Find(Query, Dpi / 72.0f);
+}
+
+void UPDF::UpdatePageSizes()
+{
+	PageSizes.Empty(Pages.Num());
+	for (const UTexture2D* Page : Pages)
+	{
+		PageSizes.Add(Page != nullptr ? FIntPoint(Page->GetSizeX(), Page->GetSizeY()) : FIntPoint::ZeroValue);
+	}
+}
+
 void UPDF::Serialize(FArchive& Ar)
 {
 	Super::Serialize(Ar);
 
 	Ar.UsingCustomVersion(PDF_GUID);
-	if (Ar.IsSaving() || (Ar.IsLoading() && (PDF_Version <= Ar.CustomVer(PDF_GUID))))
+	if (Ar.IsSaving() || (Ar.IsLoading() && (PDF_Version_Initial <= Ar.CustomVer(PDF_GUID))))
 	{
 		Ar << PageRange.FirstPage << PageRange.LastPage << Dpi << Pages << Filename << TimeStamp;
 	}
+	if (Ar.IsSaving() || (Ar.IsLoading() && (PDF_Version_PageSizes <= Ar.CustomVer(PDF_GUID))))
+	{
+		Ar << PageSizes;
+	}
+	if (Ar.IsSaving() || (Ar.IsLoading() && (PDF_Version_TextIndex <= Ar.CustomVer(PDF_GUID))))
+	{
+		Ar << TextIndex;
+	}
+	if (Ar.IsSaving() || (Ar.IsLoading() && (PDF_Version_PageFingerprints <= Ar.CustomVer(PDF_GUID))))
+	{
+		Ar << PageFingerprints;
+	}
 }
 
 void UPDF::PostInitProperties()
@@ -56,6 +99,12 @@ void UPDF::PostLoad()
 {
 	Super::PostLoad();
 
+	// ページサイズを記録する前に保存されたアセット
+	if (PageSizes.Num() != Pages.Num())
+	{
+		UpdatePageSizes();
+	}
+
 #if WITH_EDITORONLY_DATA
 	if (AssetImportData == nullptr)
 	{
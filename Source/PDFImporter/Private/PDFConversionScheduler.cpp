@@ -0,0 +1,298 @@
+#include "PDFConversionScheduler.h"
+#include "PDFImporter.h"
+#include "GhostscriptCore.h"
+#include "AsyncExecTask.h"
+#include "Async/Async.h"
+#include "Misc/Paths.h"
+#include "Misc/QueuedThreadPool.h"
+#include "HAL/PlatformMisc.h"
+
+FString FPDFConversionRequest::GetKey() const
+{
+	// 同じファイルを別の書き方で指定しても同じジョブになるように絶対パスにする
+	FString FullPath = FPaths::ConvertRelativePathToFull(InputPath);
+	FPaths::NormalizeFilename(FullPath);
+	return FString::Printf(TEXT("%s|%d|%d|%d|%d|%d|%d|%d"), *FullPath, Dpi, FirstPage, LastPage, (int)RenderMode, (int)Backend, bExtractText ? 1 : 0, PreviewDpi);
+}
+
+FPDFConversionScheduler::FPDFConversionScheduler(TSharedPtr<FGhostscriptCore> InGhostscriptCore, int InMaxRunningJobs)
+	: GhostscriptCore(InGhostscriptCore), ThreadPool(nullptr), MaxRunningJobs(InMaxRunningJobs), bIsShuttingDown(false), NumRunningJobs(0), NextHandle(1)
+{
+	// エンジンの他の非同期処理を妨げないように、共有のスレッドプールとは別のスレッドで変換する
+	if (MaxRunningJobs <= 0)
+	{
+		MaxRunningJobs = FMath::Max(FPlatformMisc::NumberOfCores() / 2, 1);
+	}
+
+	ThreadPool = FQueuedThreadPool::Allocate();
+	ThreadPool->Create(MaxRunningJobs, 128 * 1024, TPri_BelowNormal);
+	UE_LOG(PDFImporter, Log, TEXT("Up to %d conversions run at the same time"), MaxRunningJobs);
+}
+
+FPDFConversionScheduler::~FPDFConversionScheduler()
+{
+	// 待っているジョブは破棄し、実行中のジョブは中断させる
+	{
+		FScopeLock Lock(&JobsLock);
+		bIsShuttingDown = true;
+		for (TArray<TSharedPtr<FJob>>& WaitingJobsOfPriority : WaitingJobs)
+		{
+			WaitingJobsOfPriority.Empty();
+		}
+		for (TPair<FString, TSharedPtr<FJob>>& Pair : Jobs)
+		{
+			Pair.Value->Token->Cancel();
+		}
+	}
+
+	// 実行中のジョブが終わるのを待つ
+	ThreadPool->Destroy();
+	delete ThreadPool;
+	ThreadPool = nullptr;
+}
+
+uint64 FPDFConversionScheduler::Schedule(const FPDFConversionRequest& Request, EPDFConversionPriority Priority, const FPDFConversionCallbacks& Callbacks, TSharedPtr<FPDFConversionToken>& OutToken)
+{
+	FScopeLock Lock(&JobsLock);
+
+	const uint64 Handle = NextHandle++;
+	const FString Key = Request.GetKey();
+
+	// 同じファイルと設定のジョブがあれば、その結果を受け取る
+	TSharedPtr<FJob>* ExistingJob = Jobs.Find(Key);
+	if (ExistingJob != nullptr)
+	{
+		TSharedPtr<FJob> Job = *ExistingJob;
+		Job->Subscribers.Add({ Handle, Callbacks });
+		OutToken = Job->Token;
+
+		// 待っているジョブは優先度の高い方に合わせる
+		if (Priority < Job->Priority && WaitingJobs[(int)Job->Priority].Remove(Job) > 0)
+		{
+			Job->Priority = Priority;
+			WaitingJobs[(int)Priority].Add(Job);
+		}
+
+		// 読み込み済みのページは後から届ける
+		if (Job->LoadedPages.Num() > 0)
+		{
+			TWeakPtr<FPDFConversionScheduler, ESPMode::ThreadSafe> WeakThis = AsShared();
+			AsyncTask(ENamedThreads::GameThread, [WeakThis, Job, Handle]()
+			{
+				TSharedPtr<FPDFConversionScheduler, ESPMode::ThreadSafe> This = WeakThis.Pin();
+				if (!This.IsValid())
+				{
+					return;
+				}
+
+				// 届ける前にキャンセルされた要求には何もしない
+				TFunction<void(int, UTexture2D*)> OnPageLoaded;
+				TArray<TPair<int, UTexture2D*>> LoadedPages;
+				{
+					FScopeLock Lock(&This->JobsLock);
+					const FSubscriber* Subscriber = Job->Subscribers.FindByPredicate([Handle](const FSubscriber& Candidate) { return Candidate.Handle == Handle; });
+					if (Subscriber == nullptr)
+					{
+						return;
+					}
+					OnPageLoaded = Subscriber->Callbacks.OnPageLoaded;
+					LoadedPages = Job->LoadedPages;
+				}
+
+				if (OnPageLoaded)
+				{
+					for (const TPair<int, UTexture2D*>& LoadedPage : LoadedPages)
+					{
+						OnPageLoaded(LoadedPage.Key, LoadedPage.Value);
+					}
+				}
+			});
+		}
+
+		UE_LOG(PDFImporter, Log, TEXT("Joined the conversion of %s that is already scheduled"), *Request.InputPath);
+		return Handle;
+	}
+
+	TSharedPtr<FJob> Job = MakeShared<FJob>();
+	Job->Request = Request;
+	Job->Key = Key;
+	Job->Priority = Priority;
+	Job->Subscribers.Add({ Handle, Callbacks });
+	OutToken = Job->Token;
+
+	Jobs.Add(Key, Job);
+	WaitingJobs[(int)Priority].Add(Job);
+	StartWaitingJobs();
+
+	return Handle;
+}
+
+void FPDFConversionScheduler::Cancel(uint64 Handle)
+{
+	TFunction<void(UPDF*)> OnFinished;
+	{
+		FScopeLock Lock(&JobsLock);
+
+		for (TPair<FString, TSharedPtr<FJob>>& Pair : Jobs)
+		{
+			TSharedPtr<FJob> Job = Pair.Value;
+			const int SubscriberIndex = Job->Subscribers.IndexOfByPredicate([Handle](const FSubscriber& Subscriber) { return Subscriber.Handle == Handle; });
+			if (SubscriberIndex == INDEX_NONE)
+			{
+				continue;
+			}
+
+			OnFinished = Job->Subscribers[SubscriberIndex].Callbacks.OnFinished;
+			Job->Subscribers.RemoveAt(SubscriberIndex);
+
+			// 誰も待っていないジョブは中断し、同じ要求が来たら新しいジョブで変換し直す
+			if (Job->Subscribers.Num() == 0)
+			{
+				Job->Token->Cancel();
+				WaitingJobs[(int)Job->Priority].Remove(Job);
+				Jobs.Remove(Job->Key);
+			}
+			break;
+		}
+	}
+
+	if (OnFinished)
+	{
+		OnFinished(nullptr);
+	}
+}
+
+void FPDFConversionScheduler::StartWaitingJobs()
+{
+	if (bIsShuttingDown)
+	{
+		return;
+	}
+
+	while (NumRunningJobs < MaxRunningJobs)
+	{
+		// 優先度の高い順に、同じ優先度なら要求された順に始める
+		TSharedPtr<FJob> Job;
+		for (TArray<TSharedPtr<FJob>>& WaitingJobsOfPriority : WaitingJobs)
+		{
+			if (WaitingJobsOfPriority.Num() > 0)
+			{
+				Job = WaitingJobsOfPriority[0];
+				WaitingJobsOfPriority.RemoveAt(0);
+				break;
+			}
+		}
+		if (!Job.IsValid())
+		{
+			return;
+		}
+
+		++NumRunningJobs;
+		TWeakPtr<FPDFConversionScheduler, ESPMode::ThreadSafe> WeakThis = AsShared();
+		auto ConvertTask = new FAutoDeleteAsyncTask<FAsyncExecTask>([this, WeakThis, Job]()
+		{
+			RunJob(WeakThis, Job);
+		});
+		ConvertTask->StartBackgroundTask(ThreadPool);
+	}
+}
+
+void FPDFConversionScheduler::RunJob(TWeakPtr<FPDFConversionScheduler, ESPMode::ThreadSafe> WeakThis, TSharedPtr<FJob> Job)
+{
+	const FPDFConversionRequest& Request = Job->Request;
+
+	// 始まる前にキャンセルされたジョブは変換しない
+	UPDF* PDFAsset = nullptr;
+	if (!Job->Token->IsCanceled())
+	{
+		// 読み込めたページからゲームスレッドに通知する
+		PDFAsset = GhostscriptCore->ConvertPdfToPdfAsset(Request.InputPath, Request.Dpi, Request.FirstPage, Request.LastPage, Request.RenderMode, Request.Backend, false, [WeakThis, Job](int PageIndex, UTexture2D* Page)
+		{
+			AsyncTask(ENamedThreads::GameThread, [WeakThis, Job, PageIndex, Page]()
+			{
+				TSharedPtr<FPDFConversionScheduler, ESPMode::ThreadSafe> This = WeakThis.Pin();
+				if (This.IsValid())
+				{
+					This->NotifyPageLoaded(Job, PageIndex, Page);
+				}
+			});
+		}, &Job->Token.Get(), Request.PreviewDpi);
+
+		// 検索できるようにテキストを抽出する
+		if (PDFAsset != nullptr && Request.bExtractText)
+		{
+			GhostscriptCore->ExtractText(Request.InputPath, Request.FirstPage, Request.LastPage, PDFAsset->TextIndex, &Job->Token.Get());
+		}
+	}
+
+	// ページの通知より後に届くように、結果もゲームスレッドで通知する
+	AsyncTask(ENamedThreads::GameThread, [WeakThis, Job, PDFAsset]()
+	{
+		TSharedPtr<FPDFConversionScheduler, ESPMode::ThreadSafe> This = WeakThis.Pin();
+		if (This.IsValid())
+		{
+			This->NotifyFinished(Job, PDFAsset);
+		}
+	});
+
+	// 空いたワーカーで次のジョブを始める
+	FScopeLock Lock(&JobsLock);
+	--NumRunningJobs;
+	StartWaitingJobs();
+}
+
+void FPDFConversionScheduler::NotifyPageLoaded(TSharedPtr<FJob> Job, int PageIndex, UTexture2D* Page)
+{
+	TArray<FSubscriber> Subscribers;
+	{
+		FScopeLock Lock(&JobsLock);
+
+		// プレビューが差し替えられたページは新しい方を残す
+		TPair<int, UTexture2D*>* LoadedPage = Job->LoadedPages.FindByPredicate([PageIndex](const TPair<int, UTexture2D*>& Candidate) { return Candidate.Key == PageIndex; });
+		if (LoadedPage != nullptr)
+		{
+			LoadedPage->Value = Page;
+		}
+		else
+		{
+			Job->LoadedPages.Add(TPair<int, UTexture2D*>(PageIndex, Page));
+		}
+		Subscribers = Job->Subscribers;
+	}
+
+	for (const FSubscriber& Subscriber : Subscribers)
+	{
+		if (Subscriber.Callbacks.OnPageLoaded)
+		{
+			Subscriber.Callbacks.OnPageLoaded(PageIndex, Page);
+		}
+	}
+}
+
+void FPDFConversionScheduler::NotifyFinished(TSharedPtr<FJob> Job, UPDF* PDF)
+{
+	TArray<FSubscriber> Subscribers;
+	{
+		FScopeLock Lock(&JobsLock);
+
+		// キャンセルされて別のジョブに置き換わっている場合は残す
+		const TSharedPtr<FJob>* RegisteredJob = Jobs.Find(Job->Key);
+		if (RegisteredJob != nullptr && *RegisteredJob == Job)
+		{
+			Jobs.Remove(Job->Key);
+		}
+		Subscribers = MoveTemp(Job->Subscribers);
+		Job->Subscribers.Empty();
+	}
+
+	for (const FSubscriber& Subscriber : Subscribers)
+	{
+		if (Subscriber.Callbacks.OnFinished)
+		{
+			Subscriber.Callbacks.OnFinished(PDF);
+		}
+	}
+
+	// 結果を渡し終えたので、アセットとページの保持は受け取った側に任せる
+	Job->Token->ReleaseObjects();
+}
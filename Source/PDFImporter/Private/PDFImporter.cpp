@@ -2,16 +2,22 @@
 
 #include "PDFImporter.h"
 #include "GhostscriptCore.h"
+#include "PDFConversionScheduler.h"
+#include "PDFImporterSettings.h"
 
 #define LOCTEXT_NAMESPACE "FPDFImporterModule"
 
 void FPDFImporterModule::StartupModule()
 {
 	GhostscriptCore = MakeShareable(new FGhostscriptCore());
+	ConversionScheduler = MakeShared<FPDFConversionScheduler, ESPMode::ThreadSafe>(GhostscriptCore, GetDefault<UPDFImporterSettings>()->MaxConcurrentConversions);
 }
 
 void FPDFImporterModule::ShutdownModule()
 {
+	// ゲームスレッドを待っている変換が終われるようにしてから、実行中の変換を止める
+	GhostscriptCore->StopTextureUploads();
+	ConversionScheduler.Reset();
 	GhostscriptCore.Reset();
 }
 
@@ -2,6 +2,7 @@
 
 #include "PDFImporterBPLibrary.h"
 #include "PDFImporter.h"
+#include "GhostscriptCore.h"
 #include "Engine.h"
 #include "Developer/DesktopPlatform/Public/IDesktopPlatform.h"
 #include "Developer/DesktopPlatform/Public/DesktopPlatformModule.h"
@@ -28,6 +29,12 @@ void UPDFImporterBPLibrary::OpenPDFDialogMultiple(const FString& DefaultPath, EO
 	OutputPin = ExecOpenFileDialog(DefaultPath, FileNames, true);
 }
 
+bool UPDFImporterBPLibrary::ProbePdf(const FString& FilePath, FPDFDocumentInfo& DocumentInfo)
+{
+	FPDFImporterModule& PDFImporterModule = FModuleManager::LoadModuleChecked<FPDFImporterModule>(FName("PDFImporter"));
+	return PDFImporterModule.GetGhostscriptCore()->ProbePdf(FilePath, DocumentInfo);
+}
+
 FString UPDFImporterBPLibrary::ConvertFPageRangeToFString(FPageRange InPageRange)
 {
 	return FString::FromInt(InPageRange.FirstPage) + TEXT(" - ") + FString::FromInt(InPageRange.LastPage);
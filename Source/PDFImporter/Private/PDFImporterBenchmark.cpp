@@ -0,0 +1,233 @@
+#include "PDFImporterBenchmark.h"
+#include "PDFImporter.h"
+#include "GhostscriptCore.h"
+#include "GhostscriptRasterizer.h"
+#include "GhostscriptInstancePool.h"
+#include "PDFiumRasterizer.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/FileManager.h"
+#include "Async/Async.h"
+#include "Misc/Paths.h"
+
+// PDFImporter.BenchmarkInstancePool <PDFファイルのパス> [回数] [DPI]
+static FAutoConsoleCommand BenchmarkInstancePoolCommand(
+	TEXT("PDFImporter.BenchmarkInstancePool"),
+	TEXT("Compares per-document latency of one-shot and pooled Ghostscript interpreters. Usage: PDFImporter.BenchmarkInstancePool <Path> [Iterations] [Dpi]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&FPDFImporterBenchmark::BenchmarkInstancePool)
+);
+
+// PDFImporter.BenchmarkRasterizers <PDFファイルかディレクトリのパス> [DPI]
+static FAutoConsoleCommand BenchmarkRasterizersCommand(
+	TEXT("PDFImporter.BenchmarkRasterizers"),
+	TEXT("Compares pages/sec and peak memory of the Ghostscript and PDFium rasterizers. Usage: PDFImporter.BenchmarkRasterizers <Path|Directory> [Dpi]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&FPDFImporterBenchmark::BenchmarkRasterizers)
+);
+
+void FPDFImporterBenchmark::BenchmarkInstancePool(const TArray<FString>& Args)
+{
+	if (Args.Num() < 1)
+	{
+		UE_LOG(PDFImporter, Warning, TEXT("Usage: PDFImporter.BenchmarkInstancePool <Path> [Iterations] [Dpi]"));
+		return;
+	}
+
+	const FString InputPath = Args[0];
+	const int Iterations = (Args.Num() > 1) ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 10;
+	const int Dpi = (Args.Num() > 2) ? FMath::Max(FCString::Atoi(*Args[2]), 1) : 72;
+
+	FPDFImporterModule& PDFImporterModule = FModuleManager::LoadModuleChecked<FPDFImporterModule>(FName("PDFImporter"));
+	TSharedPtr<FGhostscriptCore> GhostscriptCore = PDFImporterModule.GetGhostscriptCore();
+	if (!GhostscriptCore.IsValid() || !GhostscriptCore->Ghostscript.IsValid())
+	{
+		return;
+	}
+	FGhostscriptRasterizer& Ghostscript = *GhostscriptCore->Ghostscript;
+
+	// 毎回インスタンスを作り直す場合
+	const double OneShotSeconds = MeasureBitmapConversion(Ghostscript, InputPath, Dpi, Iterations, false);
+
+	// 起動済みのインスタンスを使い回す場合（使う1つを先に起動して、初回の起動コストは計測に含めない）
+	Ghostscript.GetInstancePool().Prewarm(1);
+	const double PooledSeconds = MeasureBitmapConversion(Ghostscript, InputPath, Dpi, Iterations, true);
+
+	if (OneShotSeconds < 0.0 || PooledSeconds < 0.0)
+	{
+		UE_LOG(PDFImporter, Error, TEXT("Benchmark failed : %s"), *InputPath);
+		return;
+	}
+
+	const double OneShotMs = OneShotSeconds * 1000.0 / Iterations;
+	const double PooledMs = PooledSeconds * 1000.0 / Iterations;
+	UE_LOG(PDFImporter, Display, TEXT("Instance pool benchmark : %s (%d iterations, %d dpi)"), *InputPath, Iterations, Dpi);
+	UE_LOG(PDFImporter, Display, TEXT("  One-shot : %.2f ms/document"), OneShotMs);
+	UE_LOG(PDFImporter, Display, TEXT("  Pooled   : %.2f ms/document"), PooledMs);
+	UE_LOG(PDFImporter, Display, TEXT("  Saved    : %.2f ms/document"), OneShotMs - PooledMs);
+}
+
+double FPDFImporterBenchmark::MeasureBitmapConversion(FGhostscriptRasterizer& Ghostscript, const FString& InputPath, int Dpi, int Iterations, bool bUseInstancePool)
+{
+	// ページは受け取ってすぐに捨てる
+	const FPDFPageRenderedCallback DiscardPage = [](int PageIndex, FPDFPageBitmap& Page) {};
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	for (int Index = 0; Index < Iterations; ++Index)
+	{
+		// どちらも1つのインタプリタで描画させ、起動し直すかどうかの違いだけを比べる
+		const bool bIsSucceeded = bUseInstancePool
+			? Ghostscript.GetInstancePool().StreamPdfToBitmap(InputPath, Dpi, 0, 0, DiscardPage, nullptr)
+			: Ghostscript.StreamPdfToBitmap(InputPath, Dpi, 0, 0, DiscardPage, nullptr, false);
+		if (!bIsSucceeded)
+		{
+			return -1.0;
+		}
+	}
+
+	return FPlatformTime::Seconds() - StartTime;
+}
+
+void FPDFImporterBenchmark::BenchmarkRasterizers(const TArray<FString>& Args)
+{
+	if (Args.Num() < 1)
+	{
+		UE_LOG(PDFImporter, Warning, TEXT("Usage: PDFImporter.BenchmarkRasterizers <Path|Directory> [Dpi]"));
+		return;
+	}
+
+	const int Dpi = (Args.Num() > 1) ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 150;
+
+	// ディレクトリが指定された場合は中のPDFをすべて対象にする
+	TArray<FString> InputPaths;
+	if (IFileManager::Get().DirectoryExists(*Args[0]))
+	{
+		IFileManager::Get().FindFiles(InputPaths, *FPaths::Combine(Args[0], TEXT("*.pdf")), true, false);
+		for (FString& InputPath : InputPaths)
+		{
+			InputPath = FPaths::Combine(Args[0], InputPath);
+		}
+		InputPaths.Sort();
+	}
+	else
+	{
+		InputPaths.Add(Args[0]);
+	}
+
+	if (InputPaths.Num() == 0)
+	{
+		UE_LOG(PDFImporter, Error, TEXT("No PDF found : %s"), *Args[0]);
+		return;
+	}
+
+	FPDFImporterModule& PDFImporterModule = FModuleManager::LoadModuleChecked<FPDFImporterModule>(FName("PDFImporter"));
+	TSharedPtr<FGhostscriptCore> GhostscriptCore = PDFImporterModule.GetGhostscriptCore();
+	if (!GhostscriptCore.IsValid())
+	{
+		return;
+	}
+
+	UE_LOG(PDFImporter, Display, TEXT("Rasterizer benchmark : %s (%d files, %d dpi)"), *Args[0], InputPaths.Num(), Dpi);
+
+	TArray<IPDFRasterizer*> Rasterizers;
+	if (GhostscriptCore->Ghostscript.IsValid())
+	{
+		Rasterizers.Add(GhostscriptCore->Ghostscript.Get());
+	}
+	if (GhostscriptCore->PDFium.IsValid())
+	{
+		Rasterizers.Add(GhostscriptCore->PDFium.Get());
+	}
+	if (Rasterizers.Num() == 0)
+	{
+		return;
+	}
+
+	// バックエンドごとの集計
+	struct FRasterizerResult
+	{
+		int PageCount = 0;
+		double Seconds = 0.0;
+		uint64 PeakGrowth = 0;
+		bool bIsFailed = false;
+	};
+	TArray<FRasterizerResult> Results;
+	Results.SetNum(Rasterizers.Num());
+
+	// 実行順で有利不利が出ないように、ファイルごとに最初に描画するバックエンドを入れ替える
+	for (int FileIndex = 0; FileIndex < InputPaths.Num(); ++FileIndex)
+	{
+		for (int Offset = 0; Offset < Rasterizers.Num(); ++Offset)
+		{
+			const int RasterizerIndex = (FileIndex + Offset) % Rasterizers.Num();
+			FRasterizerResult& Result = Results[RasterizerIndex];
+			if (Result.bIsFailed)
+			{
+				continue;
+			}
+
+			int PageCount = 0;
+			double Seconds = 0.0;
+			uint64 PeakGrowth = 0;
+			if (!MeasureRasterizer(*Rasterizers[RasterizerIndex], InputPaths[FileIndex], Dpi, PageCount, Seconds, PeakGrowth))
+			{
+				UE_LOG(PDFImporter, Error, TEXT("  %s failed : %s"), *Rasterizers[RasterizerIndex]->GetRasterizerName().ToString(), *InputPaths[FileIndex]);
+				Result.bIsFailed = true;
+				continue;
+			}
+
+			Result.PageCount += PageCount;
+			Result.Seconds += Seconds;
+			Result.PeakGrowth = FMath::Max(Result.PeakGrowth, PeakGrowth);
+		}
+	}
+
+	for (int RasterizerIndex = 0; RasterizerIndex < Rasterizers.Num(); ++RasterizerIndex)
+	{
+		const FRasterizerResult& Result = Results[RasterizerIndex];
+		if (Result.bIsFailed)
+		{
+			UE_LOG(PDFImporter, Error, TEXT("  %-11s : failed"), *Rasterizers[RasterizerIndex]->GetRasterizerName().ToString());
+			continue;
+		}
+
+		UE_LOG(PDFImporter, Display, TEXT("  %-11s : %d pages in %.2f s, %.2f pages/sec, peak +%.1f MB"),
+			*Rasterizers[RasterizerIndex]->GetRasterizerName().ToString(), Result.PageCount, Result.Seconds,
+			(Result.Seconds > 0.0) ? Result.PageCount / Result.Seconds : 0.0, Result.PeakGrowth / (1024.0 * 1024.0));
+	}
+}
+
+bool FPDFImporterBenchmark::MeasureRasterizer(IPDFRasterizer& Rasterizer, const FString& InputPath, int Dpi, int& OutPageCount, double& OutSeconds, uint64& OutPeakGrowth)
+{
+	// プロセス全体の使用量には描画と関係ない分も含まれるので、描画を始める前の使用量からの増分を計る
+	const uint64 StartUsedPhysical = FPlatformMemory::GetStats().UsedPhysical;
+
+	// 変換中の使用量を別スレッドでサンプリングする
+	FThreadSafeBool bIsMeasuring = true;
+	TFuture<uint64> PeakUsedPhysical = Async(EAsyncExecution::Thread, [&bIsMeasuring, StartUsedPhysical]()
+	{
+		uint64 Peak = StartUsedPhysical;
+		while (bIsMeasuring)
+		{
+			Peak = FMath::Max<uint64>(Peak, FPlatformMemory::GetStats().UsedPhysical);
+			FPlatformProcess::Sleep(0.005f);
+		}
+		return Peak;
+	});
+
+	// ページを溜め込むとその分を計ってしまうので、受け取ったページはすぐに捨てる
+	int PageCount = 0;
+	const double StartTime = FPlatformTime::Seconds();
+	const bool bIsSucceeded = Rasterizer.StreamPdfToBitmap(InputPath, Dpi, 0, 0, [&PageCount](int PageIndex, FPDFPageBitmap& Page)
+	{
+		++PageCount;
+	}, nullptr);
+
+	OutSeconds = FPlatformTime::Seconds() - StartTime;
+	bIsMeasuring = false;
+	OutPeakGrowth = PeakUsedPhysical.Get() - StartUsedPhysical;
+	OutPageCount = PageCount;
+
+	return bIsSucceeded;
+}
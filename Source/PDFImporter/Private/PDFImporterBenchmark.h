@@ -0,0 +1,22 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Console commands that measure conversion performance
+class FPDFImporterBenchmark
+{
+public:
+	// Compare the latency of one-shot and pooled Ghostscript interpreters
+	static void BenchmarkInstancePool(const TArray<FString>& Args);
+
+	// Compare the throughput and peak memory growth of every available rasterizer on the same corpus
+	// The rasterizers take turns on each file so the order they run in does not favor one of them
+	static void BenchmarkRasterizers(const TArray<FString>& Args);
+
+private:
+	// Get the seconds taken to convert the PDF the specified number of times
+	static double MeasureBitmapConversion(class FGhostscriptRasterizer& Ghostscript, const FString& InputPath, int Dpi, int Iterations, bool bUseInstancePool);
+
+	// Stream the pages of a PDF and get the pages rendered, the seconds taken and the peak growth of physical memory during the render
+	static bool MeasureRasterizer(class IPDFRasterizer& Rasterizer, const FString& InputPath, int Dpi, int& OutPageCount, double& OutSeconds, uint64& OutPeakGrowth);
+};
@@ -0,0 +1,262 @@
+#include "PDFRenderCache.h"
+#include "PDFImporter.h"
+#include "IPDFRasterizer.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Guid.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Misc/SecureHash.h"
+
+namespace
+{
+	// キャッシュの形式を変えた時に上げる
+	const int RenderCacheVersion = 2;
+
+	// エントリの内容を記録するファイル（これがあるエントリだけが完成している）
+	const TCHAR* ManifestFilename = TEXT("Entry.txt");
+
+	// 書き込み中のエントリのディレクトリに付ける拡張子
+	const TCHAR* StagingSuffix = TEXT(".staging");
+}
+
+FPDFRenderCache::FPDFRenderCache(const FString& InCacheDirectory, int64 InMaxCacheSize)
+	: CacheDirectory(FPaths::ConvertRelativePathToFull(InCacheDirectory)), MaxCacheSize(InMaxCacheSize)
+{
+	IFileManager& FileManager = IFileManager::Get();
+
+	// 前回中断された書き込み中のエントリを削除
+	TArray<FString> StagingDirectories;
+	FileManager.FindFiles(StagingDirectories, *FPaths::Combine(CacheDirectory, FString(TEXT("*")) + StagingSuffix), false, true);
+	for (const FString& StagingDirectory : StagingDirectories)
+	{
+		FileManager.DeleteDirectory(*FPaths::Combine(CacheDirectory, StagingDirectory), false, true);
+	}
+}
+
+FString FPDFRenderCache::MakeKey(const FString& InputPath, int Dpi, int FirstPage, int LastPage, EPDFRenderMode RenderMode, EPDFRasterizerBackend Backend)
+{
+	// ファイル名ではなく内容で識別する
+	const FMD5Hash ContentHash = FMD5Hash::HashFile(*InputPath);
+	if (!ContentHash.IsValid())
+	{
+		return FString();
+	}
+
+	// 全ページを表す範囲は1つにまとめる
+	if (FirstPage <= 0 || LastPage <= 0 || FirstPage > LastPage)
+	{
+		FirstPage = 0;
+		LastPage = 0;
+	}
+
+	const FString Settings = FString::Printf(TEXT("%s-%d-%d-%d-%d-%d-%d"),
+		*LexToString(ContentHash), Dpi, FirstPage, LastPage, (int)RenderMode, (int)Backend, RenderCacheVersion
+	);
+	return FMD5::HashAnsiString(*Settings);
+}
+
+bool FPDFRenderCache::Find(const FString& Key, FString& OutEntryPath, FString& OutExtension, int& OutNumPages)
+{
+	const FString EntryPath = FPaths::Combine(CacheDirectory, Key);
+	const FString ManifestPath = FPaths::Combine(EntryPath, ManifestFilename);
+
+	// 見つけてから固定するまでの間に削除されないようにする
+	FScopeLock Lock(&CacheLock);
+
+	TArray<FString> Lines;
+	if (!FFileHelper::LoadFileToStringArray(Lines, *ManifestPath) || Lines.Num() < 2)
+	{
+		return false;
+	}
+
+	OutEntryPath = EntryPath;
+	OutExtension = Lines[0];
+	OutNumPages = FCString::Atoi(*Lines[1]);
+
+	if (OutNumPages <= 0)
+	{
+		return false;
+	}
+
+	// ページを通知し始めてから足りないことに気付かないように、読み込む前にページのファイルが揃っているか確認する
+	TArray<FString> PageNames;
+	IFileManager::Get().FindFiles(PageNames, *EntryPath, *OutExtension);
+	if (PageNames.Num() != OutNumPages)
+	{
+		UE_LOG(PDFImporter, Warning, TEXT("Render cache entry has %d of its %d pages, rendering again (%s)"), PageNames.Num(), OutNumPages, *EntryPath);
+		return false;
+	}
+
+	// 最近使ったエントリとして記録し、読み込み終わるまで削除されないように固定する
+	IFileManager::Get().SetTimeStamp(*ManifestPath, FDateTime::UtcNow());
+	++PinnedEntries.FindOrAdd(Key);
+
+	return true;
+}
+
+void FPDFRenderCache::ReleaseEntry(const FString& Key)
+{
+	FScopeLock Lock(&CacheLock);
+
+	int* NumReaders = PinnedEntries.Find(Key);
+	if (NumReaders != nullptr && --(*NumReaders) <= 0)
+	{
+		PinnedEntries.Remove(Key);
+	}
+}
+
+FString FPDFRenderCache::BeginEntry(const FString& Key)
+{
+	// 同じPDFを同時に変換しても衝突しないようにGUIDを付ける
+	const FString StagingPath = FPaths::Combine(CacheDirectory, Key + TEXT("-") + FGuid::NewGuid().ToString() + StagingSuffix);
+	if (!IFileManager::Get().MakeDirectory(*StagingPath, true))
+	{
+		UE_LOG(PDFImporter, Warning, TEXT("Failed to create the render cache directory (%s)"), *StagingPath);
+		return FString();
+	}
+
+	return StagingPath;
+}
+
+bool FPDFRenderCache::CommitEntry(const FString& Key, const FString& StagingPath, const FString& Extension, int NumPages)
+{
+	IFileManager& FileManager = IFileManager::Get();
+
+	// 入れるとキャッシュの他のエントリを全て追い出した上で自分も消されるので、上限より大きいエントリは残さない
+	const int64 EntrySize = GetDirectorySize(StagingPath);
+	if (EntrySize > MaxCacheSize)
+	{
+		UE_LOG(PDFImporter, Log, TEXT("Pages of %lld bytes are larger than the render cache, not caching them (%s)"), EntrySize, *StagingPath);
+		AbandonEntry(StagingPath);
+		return false;
+	}
+
+	const FString Manifest = Extension + LINE_TERMINATOR + FString::FromInt(NumPages) + LINE_TERMINATOR;
+	if (!FFileHelper::SaveStringToFile(Manifest, *FPaths::Combine(StagingPath, ManifestFilename)))
+	{
+		AbandonEntry(StagingPath);
+		return false;
+	}
+
+	FScopeLock Lock(&CacheLock);
+
+	// 先に他の変換が同じエントリを作っていればそちらを使う
+	const FString EntryPath = FPaths::Combine(CacheDirectory, Key);
+	if (FileManager.DirectoryExists(*EntryPath) || !FPlatformFileManager::Get().GetPlatformFile().MoveFile(*EntryPath, *StagingPath))
+	{
+		AbandonEntry(StagingPath);
+		return false;
+	}
+
+	UE_LOG(PDFImporter, Log, TEXT("Added %d pages to the render cache (%s)"), NumPages, *EntryPath);
+
+	Evict();
+	return true;
+}
+
+void FPDFRenderCache::AbandonEntry(const FString& StagingPath)
+{
+	if (!StagingPath.IsEmpty())
+	{
+		IFileManager::Get().DeleteDirectory(*StagingPath, false, true);
+	}
+}
+
+bool FPDFRenderCache::WriteBitmap(const FString& FilePath, const FPDFPageBitmap& Bitmap)
+{
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*FilePath));
+	if (!Writer.IsValid())
+	{
+		return false;
+	}
+
+	// BITMAPFILEHEADER(14バイト) + BITMAPINFOHEADER(40バイト)
+	// 高さを負にして上の行から並べ、BGRAの行をそのまま書き込む
+	uint8 Header[54] = { 'B', 'M' };
+	auto WriteInt32 = [&Header](int Offset, int32 Value) { for (int Index = 0; Index < 4; ++Index) { Header[Offset + Index] = (uint8)(Value >> (Index * 8)); } };
+	auto WriteInt16 = [&Header](int Offset, int16 Value) { Header[Offset] = (uint8)Value; Header[Offset + 1] = (uint8)(Value >> 8); };
+
+	WriteInt32(2, (int32)(54 + Bitmap.GetNumBytes()));
+	WriteInt32(10, 54);
+	WriteInt32(14, 40);
+	WriteInt32(18, Bitmap.Width);
+	WriteInt32(22, -Bitmap.Height);
+	WriteInt16(26, 1);
+	WriteInt16(28, 32);
+	WriteInt32(34, (int32)Bitmap.GetNumBytes());
+
+	Writer->Serialize(Header, sizeof(Header));
+	Writer->Serialize((void*)Bitmap.GetData(), Bitmap.GetNumBytes());
+
+	return Writer->Close();
+}
+
+void FPDFRenderCache::Evict()
+{
+	IFileManager& FileManager = IFileManager::Get();
+
+	struct FEntry
+	{
+		FString Path;
+		FDateTime LastUsed;
+		int64 Size;
+	};
+
+	// 完成しているエントリのサイズと最後に使われた日時を集める
+	TArray<FString> EntryNames;
+	FileManager.FindFiles(EntryNames, *FPaths::Combine(CacheDirectory, TEXT("*")), false, true);
+
+	TArray<FEntry> Entries;
+	int64 TotalSize = 0;
+	for (const FString& EntryName : EntryNames)
+	{
+		const FString EntryPath = FPaths::Combine(CacheDirectory, EntryName);
+		const FString ManifestPath = FPaths::Combine(EntryPath, ManifestFilename);
+		if (EntryName.EndsWith(StagingSuffix) || !FileManager.FileExists(*ManifestPath))
+		{
+			continue;
+		}
+
+		FEntry Entry;
+		Entry.Path = EntryPath;
+		Entry.LastUsed = FileManager.GetTimeStamp(*ManifestPath);
+		Entry.Size = GetDirectorySize(EntryPath);
+		TotalSize += Entry.Size;
+
+		// 読み込み中のエントリはサイズにだけ数えて削除しない
+		if (!PinnedEntries.Contains(EntryName))
+		{
+			Entries.Add(MoveTemp(Entry));
+		}
+	}
+
+	// 古いものから上限に収まるまで削除
+	Entries.Sort([](const FEntry& A, const FEntry& B) { return A.LastUsed < B.LastUsed; });
+	for (const FEntry& Entry : Entries)
+	{
+		if (TotalSize <= MaxCacheSize)
+		{
+			break;
+		}
+
+		if (FileManager.DeleteDirectory(*Entry.Path, false, true))
+		{
+			TotalSize -= Entry.Size;
+			UE_LOG(PDFImporter, Log, TEXT("Removed a least recently used entry from the render cache (%s)"), *Entry.Path);
+		}
+	}
+}
+
+int64 FPDFRenderCache::GetDirectorySize(const FString& DirectoryPath)
+{
+	int64 Size = 0;
+	IFileManager::Get().IterateDirectoryStat(*DirectoryPath, [&Size](const TCHAR* Path, const FFileStatData& StatData)
+	{
+		Size += StatData.bIsDirectory ? 0 : StatData.FileSize;
+		return true;
+	});
+
+	return Size;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PDF.h"
+
+struct FPDFPageBitmap;
+
+// Persistent cache of rendered pages, keyed by the contents of PDF and the render settings
+// Each entry is a directory of page image files that is loaded the same way as a fresh render
+class FPDFRenderCache
+{
+private:
+	// Directory that contains the entries
+	FString CacheDirectory;
+
+	// Size of all entries above which the least recently used ones are removed
+	int64 MaxCacheSize;
+
+	// Serializes lookups, commits and eviction between conversions running at the same time
+	FCriticalSection CacheLock;
+
+	// Number of conversions reading each entry, keyed by the key of the entry
+	// Pinned entries are not evicted until every reader releases them
+	TMap<FString, int> PinnedEntries;
+
+public:
+	// Constructor
+	FPDFRenderCache(const FString& InCacheDirectory, int64 InMaxCacheSize);
+
+	// Make the key of the pages rendered from InputPath with the given settings, or an empty string if the file cannot be read
+	static FString MakeKey(const FString& InputPath, int Dpi, int FirstPage, int LastPage, EPDFRenderMode RenderMode, EPDFRasterizerBackend Backend);
+
+	// Find a complete entry, mark it as recently used and pin it until ReleaseEntry
+	// An entry missing some of the page files of its manifest is not found
+	bool Find(const FString& Key, FString& OutEntryPath, FString& OutExtension, int& OutNumPages);
+
+	// Unpin an entry found by Find once its pages are loaded
+	void ReleaseEntry(const FString& Key);
+
+	// Create a staging directory that page files of a new entry are written to
+	FString BeginEntry(const FString& Key);
+
+	// Publish the staging directory as the entry of Key and remove old entries if the cache is full
+	// Entries larger than the whole cache are discarded instead of evicting everything else
+	bool CommitEntry(const FString& Key, const FString& StagingPath, const FString& Extension, int NumPages);
+
+	// Discard the staging directory of a conversion that failed or was canceled
+	void AbandonEntry(const FString& StagingPath);
+
+	// Write a BGRA page as a top-down 32bit BMP that FRawPageFile maps back without conversion
+	static bool WriteBitmap(const FString& FilePath, const FPDFPageBitmap& Bitmap);
+
+private:
+	// Remove the least recently used entries that are not pinned until the cache fits in MaxCacheSize
+	void Evict();
+
+	// Get the total size of the files in a directory
+	static int64 GetDirectorySize(const FString& DirectoryPath);
+};
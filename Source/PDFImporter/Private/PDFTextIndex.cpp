@@ -0,0 +1,224 @@
+#include "PDFTextIndex.h"
+#include "Algo/BinarySearch.h"
+
+namespace
+{
+	// 座標を1/4ポイント単位でuint16に収める
+	const float BoxQuantization = 4.0f;
+
+	uint16 QuantizeCoordinate(float Value)
+	{
+		return (uint16)FMath::Clamp(FMath::RoundToInt(Value * BoxQuantization), 0, 0xFFFF);
+	}
+}
+
+void FPDFTextIndex::Build(const TArray<FWord>& Words)
+{
+	Empty();
+
+	// 単語を小文字にして出現順に並べ、語ごとの出現位置を集める
+	TMap<FString, TArray<int32>> TermMap;
+	OccurrencePages.Reserve(Words.Num());
+	OccurrenceBoxes.Reserve(Words.Num() * 4);
+	for (const FWord& Word : Words)
+	{
+		const FString Term = Word.Text.ToLower();
+		if (Term.IsEmpty())
+		{
+			continue;
+		}
+
+		const int32 Occurrence = OccurrencePages.Num();
+		OccurrencePages.Add(Word.Page);
+		OccurrenceBoxes.Add(QuantizeCoordinate(Word.Box.Min.X));
+		OccurrenceBoxes.Add(QuantizeCoordinate(Word.Box.Min.Y));
+		OccurrenceBoxes.Add(QuantizeCoordinate(Word.Box.Max.X));
+		OccurrenceBoxes.Add(QuantizeCoordinate(Word.Box.Max.Y));
+		TermMap.FindOrAdd(Term).Add(Occurrence);
+	}
+
+	// 二分探索できるように語を整列して、出現位置を詰めて並べる
+	TermMap.KeySort(TLess<FString>());
+	Terms.Reserve(TermMap.Num());
+	TermOffsets.Reserve(TermMap.Num() + 1);
+	TermOccurrences.Reserve(OccurrencePages.Num());
+	OccurrenceTerms.SetNumZeroed(OccurrencePages.Num());
+	for (const TPair<FString, TArray<int32>>& Pair : TermMap)
+	{
+		const int32 TermIndex = Terms.Add(Pair.Key);
+		TermOffsets.Add(TermOccurrences.Num());
+		TermOccurrences.Append(Pair.Value);
+		for (int32 Occurrence : Pair.Value)
+		{
+			OccurrenceTerms[Occurrence] = TermIndex;
+		}
+	}
+	TermOffsets.Add(TermOccurrences.Num());
+
+	// 語に含まれるトライグラムから語を引けるようにする
+	TMap<uint64, TArray<int32>> TrigramMap;
+	for (int32 TermIndex = 0; TermIndex < Terms.Num(); ++TermIndex)
+	{
+		const FString& Term = Terms[TermIndex];
+		for (int32 Index = 0; Index + 3 <= Term.Len(); ++Index)
+		{
+			TArray<int32>& TermList = TrigramMap.FindOrAdd(MakeTrigram(*Term + Index));
+			if (TermList.Num() == 0 || TermList.Last() != TermIndex)
+			{
+				TermList.Add(TermIndex);
+			}
+		}
+	}
+
+	TrigramMap.KeySort(TLess<uint64>());
+	Trigrams.Reserve(TrigramMap.Num());
+	TrigramOffsets.Reserve(TrigramMap.Num() + 1);
+	for (const TPair<uint64, TArray<int32>>& Pair : TrigramMap)
+	{
+		Trigrams.Add(Pair.Key);
+		TrigramOffsets.Add(TrigramTerms.Num());
+		TrigramTerms.Append(Pair.Value);
+	}
+	TrigramOffsets.Add(TrigramTerms.Num());
+}
+
+TArray<FPDFTextMatch> FPDFTextIndex::Find(const FString& Query, float PointsToPixels) const
+{
+	TArray<FPDFTextMatch> Matches;
+
+	TArray<FString> QueryWords;
+	Query.ToLower().ParseIntoArrayWS(QueryWords);
+	if (QueryWords.Num() == 0 || IsEmpty())
+	{
+		return Matches;
+	}
+
+	// 各単語に一致する語を先に求める
+	TArray<TArray<int32>> WordTerms;
+	for (const FString& QueryWord : QueryWords)
+	{
+		WordTerms.Add(FindTerms(QueryWord));
+		if (WordTerms.Last().Num() == 0)
+		{
+			return Matches;
+		}
+	}
+
+	// 最初の単語の出現位置から、続く単語が同じページで並んでいるか確認する
+	for (int32 TermIndex : WordTerms[0])
+	{
+		for (int32 Offset = TermOffsets[TermIndex]; Offset < TermOffsets[TermIndex + 1]; ++Offset)
+		{
+			const int32 First = TermOccurrences[Offset];
+			const int32 Last = First + QueryWords.Num() - 1;
+			if (Last >= OccurrencePages.Num())
+			{
+				continue;
+			}
+
+			bool bIsMatched = true;
+			FBox2D Box = GetOccurrenceBox(First);
+			for (int32 WordIndex = 1; WordIndex < QueryWords.Num() && bIsMatched; ++WordIndex)
+			{
+				const int32 Occurrence = First + WordIndex;
+				bIsMatched = OccurrencePages[Occurrence] == OccurrencePages[First] &&
+					Algo::BinarySearch(WordTerms[WordIndex], OccurrenceTerms[Occurrence]) != INDEX_NONE;
+				Box += GetOccurrenceBox(Occurrence);
+			}
+
+			if (bIsMatched)
+			{
+				FPDFTextMatch Match;
+				Match.Page = OccurrencePages[First];
+				Match.Box = FBox2D(Box.Min * PointsToPixels, Box.Max * PointsToPixels);
+				Matches.Add(Match);
+			}
+		}
+	}
+
+	// ページと読む順に並べる
+	Matches.Sort([](const FPDFTextMatch& A, const FPDFTextMatch& B)
+	{
+		return A.Page != B.Page ? A.Page < B.Page : (A.Box.Min.Y != B.Box.Min.Y ? A.Box.Min.Y < B.Box.Min.Y : A.Box.Min.X < B.Box.Min.X);
+	});
+
+	return Matches;
+}
+
+void FPDFTextIndex::Empty()
+{
+	OccurrencePages.Empty();
+	OccurrenceTerms.Empty();
+	OccurrenceBoxes.Empty();
+	Terms.Empty();
+	TermOffsets.Empty();
+	TermOccurrences.Empty();
+	Trigrams.Empty();
+	TrigramOffsets.Empty();
+	TrigramTerms.Empty();
+}
+
+FArchive& operator<<(FArchive& Ar, FPDFTextIndex& Index)
+{
+	Ar << Index.OccurrencePages << Index.OccurrenceTerms << Index.OccurrenceBoxes;
+	Ar << Index.Terms << Index.TermOffsets << Index.TermOccurrences;
+	Ar << Index.Trigrams << Index.TrigramOffsets << Index.TrigramTerms;
+	return Ar;
+}
+
+TArray<int32> FPDFTextIndex::FindTerms(const FString& Word) const
+{
+	TArray<int32> Result;
+
+	// 短い単語はその単語で始まる語を整列済みの語から探す
+	if (Word.Len() < 3)
+	{
+		for (int32 TermIndex = Algo::LowerBound(Terms, Word); TermIndex < Terms.Num() && Terms[TermIndex].StartsWith(Word, ESearchCase::CaseSensitive); ++TermIndex)
+		{
+			Result.Add(TermIndex);
+		}
+		return Result;
+	}
+
+	// 単語のトライグラムをすべて含む語を候補にする（短いリストから絞り込む）
+	TArray<TArrayView<const int32>> Candidates;
+	for (int32 Index = 0; Index + 3 <= Word.Len(); ++Index)
+	{
+		const int32 TrigramIndex = Algo::BinarySearch(Trigrams, MakeTrigram(*Word + Index));
+		if (TrigramIndex == INDEX_NONE)
+		{
+			return Result;
+		}
+		Candidates.Add(TArrayView<const int32>(TrigramTerms.GetData() + TrigramOffsets[TrigramIndex], TrigramOffsets[TrigramIndex + 1] - TrigramOffsets[TrigramIndex]));
+	}
+	Candidates.Sort([](const TArrayView<const int32>& A, const TArrayView<const int32>& B) { return A.Num() < B.Num(); });
+
+	for (int32 TermIndex : Candidates[0])
+	{
+		bool bHasAllTrigrams = true;
+		for (int32 Index = 1; Index < Candidates.Num() && bHasAllTrigrams; ++Index)
+		{
+			bHasAllTrigrams = Algo::BinarySearch(Candidates[Index], TermIndex) != INDEX_NONE;
+		}
+
+		// トライグラムの順番までは分からないので、最後に語そのものを確認する
+		if (bHasAllTrigrams && Terms[TermIndex].Contains(Word, ESearchCase::CaseSensitive))
+		{
+			Result.Add(TermIndex);
+		}
+	}
+
+	return Result;
+}
+
+uint64 FPDFTextIndex::MakeTrigram(const TCHAR* Chars)
+{
+	// Unicodeの符号位置は21bitに収まる
+	return ((uint64)(Chars[0] & 0x1FFFFF) << 42) | ((uint64)(Chars[1] & 0x1FFFFF) << 21) | (uint64)(Chars[2] & 0x1FFFFF);
+}
+
+FBox2D FPDFTextIndex::GetOccurrenceBox(int32 Occurrence) const
+{
+	const uint16* Box = OccurrenceBoxes.GetData() + Occurrence * 4;
+	return FBox2D(FVector2D(Box[0], Box[1]) / BoxQuantization, FVector2D(Box[2], Box[3]) / BoxQuantization);
+}
@@ -0,0 +1,280 @@
+#include "PDFTextureUploader.h"
+#include "PDFImporter.h"
+#include "PageMipGenerator.h"
+#include "PDFConversionToken.h"
+#include "Engine/Texture2D.h"
+#include "Misc/ScopeLock.h"
+
+FPDFTextureUploader::FPDFTextureUploader(int64 InBytesPerFrame)
+	: BytesPerFrame(FMath::Max<int64>(InBytesPerFrame, 1)), bIsStopped(false)
+{
+	TickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FPDFTextureUploader::Tick));
+}
+
+FPDFTextureUploader::~FPDFTextureUploader()
+{
+	FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	Stop();
+}
+
+TFuture<UTexture2D*> FPDFTextureUploader::Upload(UTexture2D* Texture, int Width, int Height, TArray<uint8>&& Pixels, EPixelFormat PixelFormat, int NumMips, FPDFConversionToken* Owner)
+{
+	TSharedPtr<FUpload> NewUpload = MakeShared<FUpload>();
+	NewUpload->Texture = Texture;
+	NewUpload->Width = Width;
+	NewUpload->Height = Height;
+	NewUpload->Pixels = MoveTemp(Pixels);
+	NewUpload->PixelFormat = PixelFormat;
+	NewUpload->NumMips = NumMips;
+	NewUpload->Owner = Owner;
+	NewUpload->NumBytes = NewUpload->Pixels.Num();
+	return Enqueue(NewUpload);
+}
+
+TFuture<UTexture2D*> FPDFTextureUploader::Allocate(int Width, int Height, int NumMips, FPDFConversionToken* Owner)
+{
+	TSharedPtr<FUpload> NewUpload = MakeShared<FUpload>();
+	NewUpload->Width = Width;
+	NewUpload->Height = Height;
+	NewUpload->NumMips = NumMips;
+	NewUpload->bIsAllocation = true;
+	NewUpload->Owner = Owner;
+
+	// 確保するミップの分も予算に数える
+	for (int MipIndex = 0; MipIndex < NumMips; ++MipIndex)
+	{
+		const FIntPoint MipSize = FPageMipGenerator::GetMipSize(Width, Height, MipIndex);
+		NewUpload->NumBytes += GetMipBytes(MipSize.X, MipSize.Y, PF_B8G8R8A8);
+	}
+	return Enqueue(NewUpload);
+}
+
+TFuture<UTexture2D*> FPDFTextureUploader::Commit(UTexture2D* Texture)
+{
+	TSharedPtr<FUpload> NewUpload = MakeShared<FUpload>();
+	NewUpload->Texture = Texture;
+	if (Texture != nullptr && Texture->PlatformData != nullptr)
+	{
+		for (const FTexture2DMipMap& Mip : Texture->PlatformData->Mips)
+		{
+			NewUpload->NumBytes += Mip.BulkData.GetBulkDataSize();
+		}
+	}
+	return Enqueue(NewUpload);
+}
+
+void FPDFTextureUploader::Release(UTexture2D* Texture)
+{
+	if (Texture == nullptr)
+	{
+		return;
+	}
+
+	TSharedPtr<FUpload> NewUpload = MakeShared<FUpload>();
+	NewUpload->Texture = Texture;
+	NewUpload->bIsRelease = true;
+	Enqueue(NewUpload);
+}
+
+TFuture<UTexture2D*> FPDFTextureUploader::Enqueue(const TSharedPtr<FUpload>& NewUpload)
+{
+	TFuture<UTexture2D*> Result = NewUpload->Promise.GetFuture();
+
+	// ゲームスレッドからの要求は待たせるとデッドロックするのですぐに処理する
+	if (IsInGameThread())
+	{
+		NewUpload->Promise.SetValue(ProcessUpload(*NewUpload));
+		return Result;
+	}
+
+	{
+		FScopeLock Lock(&PendingUploadsLock);
+		if (!bIsStopped)
+		{
+			PendingUploads.Add(NewUpload);
+			return Result;
+		}
+	}
+
+	NewUpload->Promise.SetValue(nullptr);
+	return Result;
+}
+
+void FPDFTextureUploader::Stop()
+{
+	TArray<TSharedPtr<FUpload>> CanceledUploads;
+	{
+		FScopeLock Lock(&PendingUploadsLock);
+		bIsStopped = true;
+		CanceledUploads = MoveTemp(PendingUploads);
+		PendingUploads.Empty();
+	}
+
+	for (const TSharedPtr<FUpload>& CanceledUpload : CanceledUploads)
+	{
+		CanceledUpload->Promise.SetValue(nullptr);
+	}
+}
+
+bool FPDFTextureUploader::Tick(float DeltaTime)
+{
+	// このフレームの予算に収まる分だけを取り出す
+	TArray<TSharedPtr<FUpload>> Uploads;
+	{
+		FScopeLock Lock(&PendingUploadsLock);
+		int64 UploadedBytes = 0;
+		int NumUploads = 0;
+		while (NumUploads < PendingUploads.Num())
+		{
+			const int64 UploadBytes = PendingUploads[NumUploads]->NumBytes;
+			if (NumUploads > 0 && UploadedBytes + UploadBytes > BytesPerFrame)
+			{
+				break;
+			}
+			UploadedBytes += UploadBytes;
+			++NumUploads;
+		}
+
+		Uploads.Append(PendingUploads.GetData(), NumUploads);
+		PendingUploads.RemoveAt(0, NumUploads, false);
+	}
+
+	for (const TSharedPtr<FUpload>& Upload : Uploads)
+	{
+		Upload->Promise.SetValue(ProcessUpload(*Upload));
+	}
+
+	return true;
+}
+
+void FPDFTextureUploader::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	// 待っている要求のテクスチャは、要求したスレッドしか知らない
+	FScopeLock Lock(&PendingUploadsLock);
+	for (const TSharedPtr<FUpload>& PendingUpload : PendingUploads)
+	{
+		Collector.AddReferencedObject(PendingUpload->Texture);
+	}
+}
+
+UTexture2D* FPDFTextureUploader::ProcessUpload(FUpload& Upload)
+{
+	// 使われなかったテクスチャはリソースを作らずに破棄させる
+	if (Upload.bIsRelease)
+	{
+		Upload.Texture->MarkPendingKill();
+		return nullptr;
+	}
+
+	// ミップは呼び出し元が書き込むので、リソースはCommitまで作らない
+	if (Upload.bIsAllocation)
+	{
+		UTexture2D* Texture = UTexture2D::CreateTransient(Upload.Width, Upload.Height, PF_B8G8R8A8);
+		if (Texture != nullptr && Upload.Owner != nullptr)
+		{
+			Upload.Owner->KeepAlive(Texture);
+		}
+		if (Texture != nullptr && Upload.NumMips > 1)
+		{
+			// 下のミップも確保しておく
+			SetMipChain(Texture, Upload.Width, Upload.Height, Upload.NumMips);
+			for (int MipIndex = 1; MipIndex < Upload.NumMips; ++MipIndex)
+			{
+				FTexture2DMipMap& Mip = Texture->PlatformData->Mips[MipIndex];
+				Mip.BulkData.Lock(LOCK_READ_WRITE);
+				Mip.BulkData.Realloc(GetMipBytes(Mip.SizeX, Mip.SizeY, PF_B8G8R8A8));
+				Mip.BulkData.Unlock();
+			}
+		}
+		return Texture;
+	}
+
+	// 書き込み済みのミップからリソースを作成する
+	if (Upload.Texture != nullptr && Upload.Pixels.Num() == 0)
+	{
+		Upload.Texture->UpdateResource();
+		return Upload.Texture;
+	}
+
+	int64 ExpectedBytes = 0;
+	for (int MipIndex = 0; MipIndex < Upload.NumMips; ++MipIndex)
+	{
+		const FIntPoint MipSize = FPageMipGenerator::GetMipSize(Upload.Width, Upload.Height, MipIndex);
+		ExpectedBytes += GetMipBytes(MipSize.X, MipSize.Y, Upload.PixelFormat);
+	}
+	if (Upload.Pixels.Num() != ExpectedBytes || Upload.Pixels.Num() == 0)
+	{
+		return nullptr;
+	}
+
+	UTexture2D* Texture = Upload.Texture;
+	if (Texture == nullptr)
+	{
+		// Texture2Dを作成
+		Texture = UTexture2D::CreateTransient(Upload.Width, Upload.Height, Upload.PixelFormat);
+		if (Texture == nullptr)
+		{
+			return nullptr;
+		}
+
+		// 変換がテクスチャを受け取るまでの間に回収されないようにする
+		if (Upload.Owner != nullptr)
+		{
+			Upload.Owner->KeepAlive(Texture);
+		}
+	}
+	else if (Texture->PlatformData == nullptr || Texture->PlatformData->Mips.Num() == 0 || Texture->PlatformData->PixelFormat != Upload.PixelFormat)
+	{
+		return nullptr;
+	}
+
+	// ミップを新しいサイズで確保し直してピクセルデータを書き込む
+	SetMipChain(Texture, Upload.Width, Upload.Height, Upload.NumMips);
+	int64 Offset = 0;
+	for (FTexture2DMipMap& Mip : Texture->PlatformData->Mips)
+	{
+		const int64 MipBytes = GetMipBytes(Mip.SizeX, Mip.SizeY, Upload.PixelFormat);
+		Mip.BulkData.Lock(LOCK_READ_WRITE);
+		void* TextureData = Mip.BulkData.Realloc(MipBytes);
+		FMemory::Memcpy(TextureData, Upload.Pixels.GetData() + Offset, MipBytes);
+		Mip.BulkData.Unlock();
+		Offset += MipBytes;
+	}
+	Upload.Pixels.Empty();
+
+	// リソースの作成はレンダースレッドで初期データ付きで行われる
+	Texture->UpdateResource();
+
+	return Texture;
+}
+
+void FPDFTextureUploader::SetMipChain(UTexture2D* Texture, int Width, int Height, int NumMips)
+{
+	FTexturePlatformData* PlatformData = Texture->PlatformData;
+	PlatformData->SizeX = Width;
+	PlatformData->SizeY = Height;
+
+	// 余分なミップを削除し、足りないミップを追加する
+	while (PlatformData->Mips.Num() > NumMips)
+	{
+		PlatformData->Mips.RemoveAt(PlatformData->Mips.Num() - 1);
+	}
+	while (PlatformData->Mips.Num() < NumMips)
+	{
+		PlatformData->Mips.Add(new FTexture2DMipMap());
+	}
+
+	for (int MipIndex = 0; MipIndex < NumMips; ++MipIndex)
+	{
+		const FIntPoint MipSize = FPageMipGenerator::GetMipSize(Width, Height, MipIndex);
+		PlatformData->Mips[MipIndex].SizeX = MipSize.X;
+		PlatformData->Mips[MipIndex].SizeY = MipSize.Y;
+	}
+}
+
+int64 FPDFTextureUploader::GetMipBytes(int Width, int Height, EPixelFormat PixelFormat)
+{
+	// ブロック圧縮された形式ではブロック単位の大きさになる
+	const FPixelFormatInfo& FormatInfo = GPixelFormats[PixelFormat];
+	return (int64)FMath::DivideAndRoundUp(Width, FormatInfo.BlockSizeX) * FMath::DivideAndRoundUp(Height, FormatInfo.BlockSizeY) * FormatInfo.BlockBytes;
+}
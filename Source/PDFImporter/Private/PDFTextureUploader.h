@@ -0,0 +1,107 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "Containers/Ticker.h"
+#include "UObject/GCObject.h"
+
+class FPDFConversionToken;
+
+// Creates the runtime page textures on the game thread for the threads that convert pages
+// Requests are spread over the frames so that no more than a budget of pixel bytes is uploaded in one frame,
+// which keeps a document with many pages from stalling the game thread and the render thread
+// The textures of waiting requests are referenced until they are processed, and new textures are kept alive by the token
+// of the conversion that requested them, because the threads waiting for them are invisible to the garbage collector
+class FPDFTextureUploader : public FGCObject
+{
+private:
+	struct FUpload
+	{
+		// Texture to resize and refill, or null to create a new one
+		class UTexture2D* Texture;
+		int Width;
+		int Height;
+		TArray<uint8> Pixels;
+
+		// Format of Pixels, BGRA8 or block compressed
+		EPixelFormat PixelFormat;
+
+		// Number of mips in Pixels, stored one after another from the largest
+		int NumMips;
+
+		// Only create the texture for Commit, without creating its resource
+		bool bIsAllocation;
+
+		// Throw away Texture from Allocate that is not going to be committed
+		bool bIsRelease;
+
+		// Token of the conversion that keeps a new texture alive, the requester waits for the result so it outlives the request
+		FPDFConversionToken* Owner;
+
+		// Bytes counted against the budget of the frame
+		int64 NumBytes;
+
+		TPromise<class UTexture2D*> Promise;
+
+		FUpload() : Texture(nullptr), Width(0), Height(0), PixelFormat(PF_B8G8R8A8), NumMips(1), bIsAllocation(false), bIsRelease(false), Owner(nullptr), NumBytes(0) {}
+	};
+
+	// Requests waiting for the game thread, in the order they were made
+	TArray<TSharedPtr<FUpload>> PendingUploads;
+	FCriticalSection PendingUploadsLock;
+
+	// Pixel bytes uploaded in a frame, at least one request is uploaded in each frame
+	int64 BytesPerFrame;
+
+	// Set when the module shuts down, after which the requests fail at once
+	bool bIsStopped;
+
+	FDelegateHandle TickerHandle;
+
+public:
+	// Constructor
+	// Call on the game thread
+	FPDFTextureUploader(int64 InBytesPerFrame);
+
+	// Destructor
+	~FPDFTextureUploader();
+
+	// Create a texture of the pixel format, or resize and refill Texture when it is not null
+	// Pixels holds NumMips mips one after another from the largest
+	// On the game thread this is done at once, otherwise the result is set in one of the next frames, or nullptr on failure
+	// A new texture is kept alive by Owner when it is set
+	TFuture<class UTexture2D*> Upload(class UTexture2D* Texture, int Width, int Height, TArray<uint8>&& Pixels, EPixelFormat PixelFormat = PF_B8G8R8A8, int NumMips = 1, FPDFConversionToken* Owner = nullptr);
+
+	// Create a BGRA texture with NumMips mips that the caller writes itself, by locking their bulk data and unlocking them before Commit
+	// The bytes of the mips count against the budget of the frame, like the pixels of an upload
+	TFuture<class UTexture2D*> Allocate(int Width, int Height, int NumMips = 1, FPDFConversionToken* Owner = nullptr);
+
+	// Create the resource of a texture from Allocate once its pixels are written
+	TFuture<class UTexture2D*> Commit(class UTexture2D* Texture);
+
+	// Throw away a texture from Allocate whose pixels were never written, with its mips unlocked
+	void Release(class UTexture2D* Texture);
+
+	// Fail the waiting requests and the later ones, so that no thread waits for a frame that never comes
+	void Stop();
+
+	// FGCObject interface
+	virtual void AddReferencedObjects(FReferenceCollector& Collector) override;
+	// End of FGCObject interface
+
+private:
+	// Process a request on the game thread at once or in one of the next frames
+	TFuture<class UTexture2D*> Enqueue(const TSharedPtr<FUpload>& NewUpload);
+
+	// Upload the requests that fit in the budget of this frame
+	bool Tick(float DeltaTime);
+
+	// Create or update the texture of a request on the game thread
+	static class UTexture2D* ProcessUpload(FUpload& Upload);
+
+	// Resize the mips of a texture to a chain of NumMips mips for the size of the top mip
+	static void SetMipChain(class UTexture2D* Texture, int Width, int Height, int NumMips);
+
+	// Get the bytes of a mip of the pixel format
+	static int64 GetMipBytes(int Width, int Height, EPixelFormat PixelFormat);
+};
@@ -0,0 +1,244 @@
+#include "PDFTilePyramid.h"
+#include "PDFImporter.h"
+#include "GhostscriptCore.h"
+#include "Engine/Texture2D.h"
+#include "Async/Async.h"
+
+namespace
+{
+	// 同時に描画するタイルの数
+	const int MaxPendingTiles = 4;
+}
+
+TSharedPtr<FPDFTilePyramid> FPDFTilePyramid::Create(const FString& InputPath, EPDFRasterizerBackend Backend, int BaseDpi, int NumLevels, int MaxResidentTiles)
+{
+	FPDFImporterModule& PDFImporterModule = FModuleManager::LoadModuleChecked<FPDFImporterModule>(FName("PDFImporter"));
+	TSharedPtr<FGhostscriptCore> GhostscriptCore = PDFImporterModule.GetGhostscriptCore();
+	if (!GhostscriptCore.IsValid() || GhostscriptCore->GetRasterizer(Backend) == nullptr)
+	{
+		return nullptr;
+	}
+
+	TSharedPtr<FPDFTilePyramid> Pyramid = MakeShareable(new FPDFTilePyramid(GhostscriptCore, InputPath, Backend, FMath::Max(BaseDpi, 1), FMath::Clamp(NumLevels, 1, 15), FMath::Max(MaxResidentTiles, 1)));
+
+	// タイルの配置を決めるためにページの大きさを調べておく
+	if (!GhostscriptCore->ProbePdf(InputPath, Pyramid->DocumentInfo) || Pyramid->DocumentInfo.NumPages <= 0)
+	{
+		return nullptr;
+	}
+
+	// タイルごとに開き直さないように、ドキュメントはピラミッドの間開いておく
+	Pyramid->TileRenderer = GhostscriptCore->GetRasterizer(Backend)->OpenTileRenderer(InputPath);
+	if (!Pyramid->TileRenderer.IsValid())
+	{
+		return nullptr;
+	}
+
+	return Pyramid;
+}
+
+FPDFTilePyramid::FPDFTilePyramid(TSharedPtr<FGhostscriptCore> InGhostscriptCore, const FString& InInputPath, EPDFRasterizerBackend InBackend, int InBaseDpi, int InNumLevels, int InMaxResidentTiles)
+	: GhostscriptCore(InGhostscriptCore), InputPath(InInputPath), Backend(InBackend)
+	, BaseDpi(InBaseDpi), NumLevels(InNumLevels), MaxResidentTiles(InMaxResidentTiles)
+	, RenderedTiles(MakeShared<FRenderedTiles, ESPMode::ThreadSafe>()), NumPendingTiles(0), CurrentFrame(1)
+{
+}
+
+FPDFTilePyramid::~FPDFTilePyramid()
+{
+	// タスクはトークンを参照しているので、描画中のタイルを止めて終わるのを待つ
+	Token.Cancel();
+	for (TFuture<void>& RenderTask : RenderTasks)
+	{
+		RenderTask.Wait();
+	}
+}
+
+FIntPoint FPDFTilePyramid::GetPageSize(int Page, int Level) const
+{
+	if (Page < 1 || Page > DocumentInfo.Pages.Num())
+	{
+		return FIntPoint::ZeroValue;
+	}
+
+	// 回転したページは縦横を入れ替えて描画される
+	const FPDFPageInfo& PageInfo = DocumentInfo.Pages[Page - 1];
+	FVector2D Size = PageInfo.CropBox.GetSize();
+	if (PageInfo.Rotation % 180 != 0)
+	{
+		Size = FVector2D(Size.Y, Size.X);
+	}
+
+	const float PointsToPixels = GetLevelDpi(Level) / 72.0f;
+	return FIntPoint(FMath::Max(FMath::RoundToInt(Size.X * PointsToPixels), 1), FMath::Max(FMath::RoundToInt(Size.Y * PointsToPixels), 1));
+}
+
+int FPDFTilePyramid::ChooseLevel(int Page, float DisplayedWidth) const
+{
+	for (int Level = 0; Level < NumLevels; ++Level)
+	{
+		if (GetPageSize(Page, Level).X >= DisplayedWidth)
+		{
+			return Level;
+		}
+	}
+
+	return NumLevels - 1;
+}
+
+bool FPDFTilePyramid::GetTile(int Page, int Level, int TileX, int TileY, FTileView& OutView)
+{
+	OutView = FTileView();
+
+	FTile* Tile = Tiles.Find(MakeTileKey(Page, Level, TileX, TileY));
+	if (Tile != nullptr)
+	{
+		Tile->LastUsedFrame = CurrentFrame;
+		if (Tile->Texture != nullptr)
+		{
+			OutView.Texture = Tile->Texture;
+			return true;
+		}
+	}
+	else
+	{
+		// 粗い代わりのタイルがすぐに出るように、先に一番低い解像度のタイルを要求する
+		if (Level > 0 && !Tiles.Contains(MakeTileKey(Page, 0, TileX >> Level, TileY >> Level)))
+		{
+			RequestTile(MakeTileKey(Page, 0, TileX >> Level, TileY >> Level), Page, 0, TileX >> Level, TileY >> Level);
+		}
+		RequestTile(MakeTileKey(Page, Level, TileX, TileY), Page, Level, TileX, TileY);
+	}
+
+	// 描画されるまでは同じ範囲を含む粗いタイルの一部を拡大して使う
+	const FIntPoint LevelSize = GetPageSize(Page, Level);
+	const FVector2D RegionMin(TileX * TileSize, TileY * TileSize);
+	const FVector2D RegionMax(FMath::Min((TileX + 1) * TileSize, LevelSize.X), FMath::Min((TileY + 1) * TileSize, LevelSize.Y));
+	for (int Coarser = Level - 1; Coarser >= 0; --Coarser)
+	{
+		const int Shift = Level - Coarser;
+		FTile* CoarserTile = Tiles.Find(MakeTileKey(Page, Coarser, TileX >> Shift, TileY >> Shift));
+		if (CoarserTile == nullptr || CoarserTile->Texture == nullptr)
+		{
+			continue;
+		}
+
+		CoarserTile->LastUsedFrame = CurrentFrame;
+
+		const float Scale = 1.0f / (1 << Shift);
+		const FVector2D CoarserOrigin((TileX >> Shift) * TileSize, (TileY >> Shift) * TileSize);
+		const FVector2D CoarserSize(CoarserTile->Texture->GetSizeX(), CoarserTile->Texture->GetSizeY());
+		OutView.Texture = CoarserTile->Texture;
+		OutView.UV = FBox2D((RegionMin * Scale - CoarserOrigin) / CoarserSize, (RegionMax * Scale - CoarserOrigin) / CoarserSize);
+		return true;
+	}
+
+	return false;
+}
+
+void FPDFTilePyramid::Update()
+{
+	// 描画が終わったタイルをテクスチャにする
+	TPair<uint64, FPDFPageBitmap> RenderedTile;
+	while (RenderedTiles->Queue.Dequeue(RenderedTile))
+	{
+		--NumPendingTiles;
+
+		FTile* Tile = Tiles.Find(RenderedTile.Key);
+		if (Tile == nullptr)
+		{
+			continue;
+		}
+
+		// 描画に失敗したタイルは要求し直さずに粗いタイルで代用し続ける
+		Tile->bIsPending = false;
+		FPDFPageBitmap& Bitmap = RenderedTile.Value;
+		if (Bitmap.Pixels.Num() == (int64)Bitmap.Width * Bitmap.Height * 4 && Bitmap.Pixels.Num() > 0)
+		{
+			GhostscriptCore->LoadTexture2DFromBitmap(Bitmap.Width, Bitmap.Height, MoveTemp(Bitmap.Pixels), Tile->Texture);
+		}
+	}
+
+	RenderTasks.RemoveAll([](const TFuture<void>& RenderTask) { return RenderTask.IsReady(); });
+
+	++CurrentFrame;
+	Trim();
+}
+
+void FPDFTilePyramid::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	for (TPair<uint64, FTile>& Pair : Tiles)
+	{
+		Collector.AddReferencedObject(Pair.Value.Texture);
+	}
+}
+
+uint64 FPDFTilePyramid::MakeTileKey(int Page, int Level, int TileX, int TileY)
+{
+	// ページ24bit、レベル4bit、タイルの位置を18bitずつ
+	return ((uint64)(Page & 0xFFFFFF) << 40) | ((uint64)(Level & 0xF) << 36) | ((uint64)(TileX & 0x3FFFF) << 18) | (uint64)(TileY & 0x3FFFF);
+}
+
+void FPDFTilePyramid::RequestTile(uint64 Key, int Page, int Level, int TileX, int TileY)
+{
+	if (NumPendingTiles >= MaxPendingTiles)
+	{
+		return;
+	}
+
+	const FIntPoint PageSize = GetPageSize(Page, Level);
+	const FIntRect Region(TileX * TileSize, TileY * TileSize, FMath::Min((TileX + 1) * TileSize, PageSize.X), FMath::Min((TileY + 1) * TileSize, PageSize.Y));
+	if (Region.Width() <= 0 || Region.Height() <= 0)
+	{
+		return;
+	}
+
+	FTile& Tile = Tiles.Add(Key);
+	Tile.bIsPending = true;
+	Tile.LastUsedFrame = CurrentFrame;
+	++NumPendingTiles;
+
+	// 開いたドキュメントとキューはタスクと共有し、トークンはピラミッドがタスクの終わりを待ってから破棄する
+	TSharedPtr<IPDFTileRenderer, ESPMode::ThreadSafe> Renderer = TileRenderer;
+	TSharedRef<FRenderedTiles, ESPMode::ThreadSafe> Queue = RenderedTiles;
+	const FPDFConversionToken* CancelToken = &Token;
+	const FString Path = InputPath;
+	const int Dpi = GetLevelDpi(Level);
+	RenderTasks.Add(AsyncPool(*GhostscriptCore->RenderThreadPool, [Renderer, Queue, CancelToken, Path, Key, Page, Dpi, Region, PageSize]()
+	{
+		FPDFPageBitmap Bitmap;
+		if (!Renderer->RenderTile(Page, Dpi, Region, PageSize, Bitmap, CancelToken))
+		{
+			if (!CancelToken->IsCanceled())
+			{
+				UE_LOG(PDFImporter, Warning, TEXT("Failed to render a tile of page %d at %d dpi (%s)"), Page, Dpi, *Path);
+			}
+			Bitmap = FPDFPageBitmap();
+		}
+		Queue->Queue.Enqueue(TPair<uint64, FPDFPageBitmap>(Key, MoveTemp(Bitmap)));
+	}));
+}
+
+void FPDFTilePyramid::Trim()
+{
+	if (Tiles.Num() <= MaxResidentTiles)
+	{
+		return;
+	}
+
+	// 直前のフレームで使ったタイルと描画中のタイルは残す
+	TArray<TPair<uint64, uint64>> Candidates;
+	for (const TPair<uint64, FTile>& Pair : Tiles)
+	{
+		if (!Pair.Value.bIsPending && Pair.Value.LastUsedFrame + 1 < CurrentFrame)
+		{
+			Candidates.Add(TPair<uint64, uint64>(Pair.Value.LastUsedFrame, Pair.Key));
+		}
+	}
+
+	Candidates.Sort([](const TPair<uint64, uint64>& A, const TPair<uint64, uint64>& B) { return A.Key < B.Key; });
+	for (int Index = 0; Index < Candidates.Num() && Tiles.Num() > MaxResidentTiles; ++Index)
+	{
+		Tiles.Remove(Candidates[Index].Value);
+	}
+}
@@ -0,0 +1,301 @@
+#include "PDFiumRasterizer.h"
+#include "GenericPlatform/GenericPlatformProcess.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "PDFConversionToken.h"
+
+// fpdfview.h の定数
+#define PDFIUM_BITMAP_BGRA	4
+#define PDFIUM_RENDER_ANNOT	0x01
+#define PDFIUM_COLOR_WHITE	0xFFFFFFFF
+
+TSharedPtr<FPDFiumRasterizer, ESPMode::ThreadSafe> FPDFiumRasterizer::Create()
+{
+	TSharedPtr<FPDFiumRasterizer, ESPMode::ThreadSafe> Rasterizer = MakeShareable(new FPDFiumRasterizer());
+	if (!Rasterizer->LoadPDFiumLibrary())
+	{
+		return nullptr;
+	}
+
+	return Rasterizer;
+}
+
+FPDFiumRasterizer::FPDFiumRasterizer()
+	: PDFiumModule(nullptr)
+	, InitLibrary(nullptr), DestroyLibrary(nullptr), LoadDocument(nullptr), CloseDocument(nullptr)
+	, GetDocumentPageCount(nullptr), LoadPage(nullptr), ClosePage(nullptr), GetPageWidth(nullptr), GetPageHeight(nullptr)
+	, CreateBitmap(nullptr), FillBitmap(nullptr), RenderPageBitmap(nullptr), DestroyBitmap(nullptr), GetLastError(nullptr)
+{
+}
+
+FPDFiumRasterizer::~FPDFiumRasterizer()
+{
+	if (PDFiumModule != nullptr)
+	{
+		if (DestroyLibrary != nullptr)
+		{
+			DestroyLibrary();
+		}
+
+		FPlatformProcess::FreeDllHandle(PDFiumModule);
+		UE_LOG(PDFImporter, Log, TEXT("PDFium library unloaded"));
+	}
+}
+
+bool FPDFiumRasterizer::LoadPDFiumLibrary()
+{
+	// モジュールをロード
+	FString LoadedPath;
+	for (const FString& LibraryPath : GetLibraryPaths())
+	{
+		PDFiumModule = FPlatformProcess::GetDllHandle(*LibraryPath);
+		if (PDFiumModule != nullptr)
+		{
+			LoadedPath = LibraryPath;
+			break;
+		}
+	}
+
+	// PDFiumは任意なので、無くてもエラーにはしない
+	if (PDFiumModule == nullptr)
+	{
+		UE_LOG(PDFImporter, Log, TEXT("PDFium library not found, the PDFium rasterizer is disabled"));
+		return false;
+	}
+
+	// 関数ポインタを取得
+	InitLibrary = (FPDF_InitLibraryAPI)FPlatformProcess::GetDllExport(PDFiumModule, TEXT("FPDF_InitLibrary"));
+	DestroyLibrary = (FPDF_DestroyLibraryAPI)FPlatformProcess::GetDllExport(PDFiumModule, TEXT("FPDF_DestroyLibrary"));
+	LoadDocument = (FPDF_LoadDocumentAPI)FPlatformProcess::GetDllExport(PDFiumModule, TEXT("FPDF_LoadDocument"));
+	CloseDocument = (FPDF_CloseDocumentAPI)FPlatformProcess::GetDllExport(PDFiumModule, TEXT("FPDF_CloseDocument"));
+	GetDocumentPageCount = (FPDF_GetPageCountAPI)FPlatformProcess::GetDllExport(PDFiumModule, TEXT("FPDF_GetPageCount"));
+	LoadPage = (FPDF_LoadPageAPI)FPlatformProcess::GetDllExport(PDFiumModule, TEXT("FPDF_LoadPage"));
+	ClosePage = (FPDF_ClosePageAPI)FPlatformProcess::GetDllExport(PDFiumModule, TEXT("FPDF_ClosePage"));
+	GetPageWidth = (FPDF_GetPageSizeAPI)FPlatformProcess::GetDllExport(PDFiumModule, TEXT("FPDF_GetPageWidth"));
+	GetPageHeight = (FPDF_GetPageSizeAPI)FPlatformProcess::GetDllExport(PDFiumModule, TEXT("FPDF_GetPageHeight"));
+	CreateBitmap = (FPDFBitmap_CreateExAPI)FPlatformProcess::GetDllExport(PDFiumModule, TEXT("FPDFBitmap_CreateEx"));
+	FillBitmap = (FPDFBitmap_FillRectAPI)FPlatformProcess::GetDllExport(PDFiumModule, TEXT("FPDFBitmap_FillRect"));
+	RenderPageBitmap = (FPDF_RenderPageBitmapAPI)FPlatformProcess::GetDllExport(PDFiumModule, TEXT("FPDF_RenderPageBitmap"));
+	DestroyBitmap = (FPDFBitmap_DestroyAPI)FPlatformProcess::GetDllExport(PDFiumModule, TEXT("FPDFBitmap_Destroy"));
+	GetLastError = (FPDF_GetLastErrorAPI)FPlatformProcess::GetDllExport(PDFiumModule, TEXT("FPDF_GetLastError"));
+	if (InitLibrary == nullptr || DestroyLibrary == nullptr || LoadDocument == nullptr || CloseDocument == nullptr ||
+		GetDocumentPageCount == nullptr || LoadPage == nullptr || ClosePage == nullptr || GetPageWidth == nullptr || GetPageHeight == nullptr ||
+		CreateBitmap == nullptr || FillBitmap == nullptr || RenderPageBitmap == nullptr || DestroyBitmap == nullptr || GetLastError == nullptr)
+	{
+		UE_LOG(PDFImporter, Error, TEXT("Failed to get PDFium function pointer"));
+		DestroyLibrary = nullptr;
+		return false;
+	}
+
+	InitLibrary();
+
+	UE_LOG(PDFImporter, Log, TEXT("PDFium library loaded (%s)"), *LoadedPath);
+	return true;
+}
+
+TArray<FString> FPDFiumRasterizer::GetLibraryPaths()
+{
+	FString ThirdPartyPath = FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectPluginsDir(), TEXT("PDFImporter"), TEXT("ThirdParty")));
+
+#if PLATFORM_WINDOWS
+#ifdef _WIN64
+	return TArray<FString>{ FPaths::Combine(ThirdPartyPath, TEXT("Win64"), TEXT("pdfium.dll")) };
+#else
+	return TArray<FString>{ FPaths::Combine(ThirdPartyPath, TEXT("Win32"), TEXT("pdfium.dll")) };
+#endif
+#elif PLATFORM_LINUX
+	return TArray<FString>{ FPaths::Combine(ThirdPartyPath, TEXT("Linux"), TEXT("libpdfium.so")), TEXT("libpdfium.so") };
+#else
+	return TArray<FString>();
+#endif
+}
+
+int FPDFiumRasterizer::GetPageCount(const FString& InputPath)
+{
+	FScopeLock Lock(&PDFiumLock);
+
+	void* Document = LoadDocument(TCHAR_TO_UTF8(*InputPath), nullptr);
+	if (Document == nullptr)
+	{
+		return -1;
+	}
+
+	const int PageCount = GetDocumentPageCount(Document);
+	CloseDocument(Document);
+	return PageCount;
+}
+
+bool FPDFiumRasterizer::StreamPdfToBitmap(const FString& InputPath, int Dpi, int FirstPage, int LastPage, const FPDFPageRenderedCallback& OnPageRendered, const FPDFConversionToken* Token, const FPDFPageBufferAllocator& AllocatePageBuffer)
+{
+	FScopeLock Lock(&PDFiumLock);
+
+	// ドキュメントを開く
+	void* Document = LoadDocument(TCHAR_TO_UTF8(*InputPath), nullptr);
+	if (Document == nullptr)
+	{
+		UE_LOG(PDFImporter, Error, TEXT("PDFium failed to open %s (error %lu)"), *InputPath, GetLastError());
+		return false;
+	}
+
+	// ページ範囲をドキュメントのページ数に収める
+	const int PageCount = GetDocumentPageCount(Document);
+	if (!(FirstPage > 0 && LastPage > 0 && FirstPage <= LastPage))
+	{
+		FirstPage = 1;
+		LastPage = PageCount;
+	}
+	LastPage = FMath::Min(LastPage, PageCount);
+
+	bool bIsSucceeded = true;
+	for (int Page = FirstPage; Page <= LastPage; ++Page)
+	{
+		// ページの間でキャンセルを確認する
+		if (Token != nullptr && Token->IsCanceled())
+		{
+			UE_LOG(PDFImporter, Log, TEXT("PDFium conversion canceled : %s"), *InputPath);
+			bIsSucceeded = false;
+			break;
+		}
+
+		FPDFPageBitmap PageBitmap;
+		if (!RenderPage(Document, Page - 1, Dpi, AllocatePageBuffer, PageBitmap))
+		{
+			bIsSucceeded = false;
+			break;
+		}
+		OnPageRendered(Page - FirstPage, PageBitmap);
+	}
+
+	CloseDocument(Document);
+	return bIsSucceeded;
+}
+
+// タイルピラミッドの間ドキュメントを開いたままにして、タイルごとに読み直さないようにする
+class FPDFiumTileRenderer : public IPDFTileRenderer
+{
+private:
+	// ドキュメントを閉じるまでライブラリを解放させない
+	TSharedRef<FPDFiumRasterizer, ESPMode::ThreadSafe> PDFium;
+	void* Document;
+
+public:
+	FPDFiumTileRenderer(TSharedRef<FPDFiumRasterizer, ESPMode::ThreadSafe> InPDFium, void* InDocument)
+		: PDFium(InPDFium), Document(InDocument)
+	{
+	}
+
+	virtual ~FPDFiumTileRenderer()
+	{
+		FScopeLock Lock(&PDFium->PDFiumLock);
+		PDFium->CloseDocument(Document);
+	}
+
+	virtual bool RenderTile(int Page, int Dpi, const FIntRect& Region, const FIntPoint& PageSize, FPDFPageBitmap& OutTile, const FPDFConversionToken* Token) override
+	{
+		// PDFiumはスレッドセーフではないので、開いたままのドキュメントも他の描画と同時には使わない
+		FScopeLock Lock(&PDFium->PDFiumLock);
+
+		// 待っている間にキャンセルされていれば描画しない
+		if (Token != nullptr && Token->IsCanceled())
+		{
+			return false;
+		}
+
+		void* PageHandle = PDFium->LoadPage(Document, Page - 1);
+		if (PageHandle == nullptr)
+		{
+			UE_LOG(PDFImporter, Error, TEXT("PDFium failed to load page %d"), Page);
+			return false;
+		}
+
+		OutTile.Width = FMath::Max(Region.Width(), 1);
+		OutTile.Height = FMath::Max(Region.Height(), 1);
+		if (!OutTile.AllocatePixels())
+		{
+			PDFium->ClosePage(PageHandle);
+			return false;
+		}
+
+		bool bIsSucceeded = false;
+		void* Bitmap = PDFium->CreateBitmap(OutTile.Width, OutTile.Height, PDFIUM_BITMAP_BGRA, OutTile.Pixels.GetData(), OutTile.Width * 4);
+		if (Bitmap != nullptr)
+		{
+			// ページ全体の大きさで描画位置をずらし、タイルの範囲だけをビットマップに描画させる
+			const int PageWidth = FMath::Max(FMath::RoundToInt(PDFium->GetPageWidth(PageHandle) * Dpi / 72.0), 1);
+			const int PageHeight = FMath::Max(FMath::RoundToInt(PDFium->GetPageHeight(PageHandle) * Dpi / 72.0), 1);
+			PDFium->FillBitmap(Bitmap, 0, 0, OutTile.Width, OutTile.Height, PDFIUM_COLOR_WHITE);
+			PDFium->RenderPageBitmap(Bitmap, PageHandle, -Region.Min.X, -Region.Min.Y, PageWidth, PageHeight, 0, PDFIUM_RENDER_ANNOT);
+			PDFium->DestroyBitmap(Bitmap);
+			bIsSucceeded = true;
+		}
+
+		PDFium->ClosePage(PageHandle);
+		return bIsSucceeded;
+	}
+};
+
+TSharedPtr<IPDFTileRenderer, ESPMode::ThreadSafe> FPDFiumRasterizer::OpenTileRenderer(const FString& InputPath)
+{
+	FScopeLock Lock(&PDFiumLock);
+
+	void* Document = LoadDocument(TCHAR_TO_UTF8(*InputPath), nullptr);
+	if (Document == nullptr)
+	{
+		UE_LOG(PDFImporter, Error, TEXT("PDFium failed to open %s (error %lu)"), *InputPath, GetLastError());
+		return nullptr;
+	}
+
+	return MakeShared<FPDFiumTileRenderer, ESPMode::ThreadSafe>(StaticCastSharedRef<FPDFiumRasterizer>(AsShared()), Document);
+}
+
+bool FPDFiumRasterizer::RenderPage(void* Document, int PageIndex, int Dpi, const FPDFPageBufferAllocator& AllocatePageBuffer, FPDFPageBitmap& OutPage)
+{
+	void* Page = LoadPage(Document, PageIndex);
+	if (Page == nullptr)
+	{
+		UE_LOG(PDFImporter, Error, TEXT("PDFium failed to load page %d"), PageIndex + 1);
+		return false;
+	}
+
+	// ページサイズはポイント単位なのでDPIに合わせて変換
+	OutPage.Width = FMath::Max(FMath::RoundToInt(GetPageWidth(Page) * Dpi / 72.0), 1);
+	OutPage.Height = FMath::Max(FMath::RoundToInt(GetPageHeight(Page) * Dpi / 72.0), 1);
+
+	// 確保先が用意されていればそこへ、なければページのバッファに直接描画する
+	uint8* Pixels = AllocatePageBuffer.IsSet() ? AllocatePageBuffer.Allocate(OutPage.Width, OutPage.Height) : nullptr;
+	if (Pixels != nullptr)
+	{
+		OutPage.Buffer = Pixels;
+	}
+	else
+	{
+		if (!OutPage.AllocatePixels())
+		{
+			UE_LOG(PDFImporter, Error, TEXT("Page %d of %dx%d is too large to render into memory"), PageIndex + 1, OutPage.Width, OutPage.Height);
+			ClosePage(Page);
+			return false;
+		}
+		Pixels = OutPage.Pixels.GetData();
+	}
+
+	const int Stride = OutPage.Width * 4;
+	void* Bitmap = CreateBitmap(OutPage.Width, OutPage.Height, PDFIUM_BITMAP_BGRA, Pixels, Stride);
+	if (Bitmap == nullptr)
+	{
+		// 渡さないページのメモリは確保したスレッドで返す
+		if (OutPage.Buffer != nullptr && AllocatePageBuffer.Release)
+		{
+			AllocatePageBuffer.Release(OutPage.Buffer);
+		}
+		OutPage.Buffer = nullptr;
+		ClosePage(Page);
+		return false;
+	}
+
+	FillBitmap(Bitmap, 0, 0, OutPage.Width, OutPage.Height, PDFIUM_COLOR_WHITE);
+	RenderPageBitmap(Bitmap, Page, 0, 0, OutPage.Width, OutPage.Height, 0, PDFIUM_RENDER_ANNOT);
+
+	DestroyBitmap(Bitmap);
+	ClosePage(Page);
+	return true;
+}
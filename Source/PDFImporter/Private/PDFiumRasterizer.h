@@ -0,0 +1,78 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PDFImporter.h"
+#include "IPDFRasterizer.h"
+#include "HAL/CriticalSection.h"
+
+typedef void(*FPDF_InitLibraryAPI)();
+typedef void(*FPDF_DestroyLibraryAPI)();
+typedef void*(*FPDF_LoadDocumentAPI)(const char* FilePath, const char* Password);
+typedef void(*FPDF_CloseDocumentAPI)(void* Document);
+typedef int(*FPDF_GetPageCountAPI)(void* Document);
+typedef void*(*FPDF_LoadPageAPI)(void* Document, int PageIndex);
+typedef void(*FPDF_ClosePageAPI)(void* Page);
+typedef double(*FPDF_GetPageSizeAPI)(void* Page);
+typedef void*(*FPDFBitmap_CreateExAPI)(int Width, int Height, int Format, void* FirstScan, int Stride);
+typedef int(*FPDFBitmap_FillRectAPI)(void* Bitmap, int Left, int Top, int Width, int Height, unsigned long Color);
+typedef void(*FPDF_RenderPageBitmapAPI)(void* Bitmap, void* Page, int StartX, int StartY, int SizeX, int SizeY, int Rotate, int Flags);
+typedef void(*FPDFBitmap_DestroyAPI)(void* Bitmap);
+typedef unsigned long(*FPDF_GetLastErrorAPI)();
+
+// Rasterizer backed by the PDFium shared library
+// PDFium renders straight into the page bitmaps without going through PostScript
+class FPDFiumRasterizer : public IPDFRasterizer
+{
+private:
+	// PDFium module
+	void* PDFiumModule;
+
+	// PDFium function pointers
+	FPDF_InitLibraryAPI InitLibrary;
+	FPDF_DestroyLibraryAPI DestroyLibrary;
+	FPDF_LoadDocumentAPI LoadDocument;
+	FPDF_CloseDocumentAPI CloseDocument;
+	FPDF_GetPageCountAPI GetDocumentPageCount;
+	FPDF_LoadPageAPI LoadPage;
+	FPDF_ClosePageAPI ClosePage;
+	FPDF_GetPageSizeAPI GetPageWidth;
+	FPDF_GetPageSizeAPI GetPageHeight;
+	FPDFBitmap_CreateExAPI CreateBitmap;
+	FPDFBitmap_FillRectAPI FillBitmap;
+	FPDF_RenderPageBitmapAPI RenderPageBitmap;
+	FPDFBitmap_DestroyAPI DestroyBitmap;
+	FPDF_GetLastErrorAPI GetLastError;
+
+	// PDFium is not thread safe, so all calls are serialized
+	FCriticalSection PDFiumLock;
+
+public:
+	// Create the rasterizer, or nullptr if PDFium is not available
+	static TSharedPtr<FPDFiumRasterizer, ESPMode::ThreadSafe> Create();
+
+	// Destructor
+	virtual ~FPDFiumRasterizer();
+
+	// IPDFRasterizer interface
+	virtual FName GetRasterizerName() const override { return FName(TEXT("PDFium")); }
+	virtual int GetPageCount(const FString& InputPath) override;
+	virtual bool StreamPdfToBitmap(const FString& InputPath, int Dpi, int FirstPage, int LastPage, const FPDFPageRenderedCallback& OnPageRendered, const FPDFConversionToken* Token, const FPDFPageBufferAllocator& AllocatePageBuffer = FPDFPageBufferAllocator()) override;
+	virtual TSharedPtr<IPDFTileRenderer, ESPMode::ThreadSafe> OpenTileRenderer(const FString& InputPath) override;
+	// End of IPDFRasterizer interface
+
+private:
+	// Constructor
+	FPDFiumRasterizer();
+
+	// Load the PDFium shared library and get the function pointers
+	bool LoadPDFiumLibrary();
+
+	// Get the candidate paths of the PDFium shared library in order of priority
+	static TArray<FString> GetLibraryPaths();
+
+	// Render one page into the bitmap at the specified resolution, into the memory from AllocatePageBuffer when it is set
+	bool RenderPage(void* Document, int PageIndex, int Dpi, const FPDFPageBufferAllocator& AllocatePageBuffer, FPDFPageBitmap& OutPage);
+
+private:
+	friend class FPDFiumTileRenderer;
+};
@@ -0,0 +1,202 @@
+#include "PageCompressor.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+	// 8bitの色をRGB565に丸める
+	uint16 PackRGB565(const float (&Color)[3])
+	{
+		const int R = FMath::Clamp(FMath::RoundToInt(Color[0] * 31.0f / 255.0f), 0, 31);
+		const int G = FMath::Clamp(FMath::RoundToInt(Color[1] * 63.0f / 255.0f), 0, 63);
+		const int B = FMath::Clamp(FMath::RoundToInt(Color[2] * 31.0f / 255.0f), 0, 31);
+		return (uint16)((R << 11) | (G << 5) | B);
+	}
+
+	// RGB565をデコーダーと同じように8bitに戻す
+	void UnpackRGB565(uint16 Packed, int (&OutColor)[3])
+	{
+		const int R = (Packed >> 11) & 31;
+		const int G = (Packed >> 5) & 63;
+		const int B = Packed & 31;
+		OutColor[0] = (R << 3) | (R >> 2);
+		OutColor[1] = (G << 2) | (G >> 4);
+		OutColor[2] = (B << 3) | (B >> 2);
+	}
+}
+
+FIntPoint FPageCompressor::GetPaddedSize(int Width, int Height)
+{
+	return FIntPoint(FMath::DivideAndRoundUp(Width, 4) * 4, FMath::DivideAndRoundUp(Height, 4) * 4);
+}
+
+void FPageCompressor::PadToBlocks(int& Width, int& Height, TArray<uint8>& Pixels)
+{
+	const FIntPoint PaddedSize = GetPaddedSize(Width, Height);
+	if (PaddedSize.X == Width && PaddedSize.Y == Height)
+	{
+		return;
+	}
+
+	// 端の画素を繰り返して広げる
+	TArray<uint8> PaddedPixels;
+	PaddedPixels.SetNumUninitialized((int64)PaddedSize.X * PaddedSize.Y * 4);
+	for (int Y = 0; Y < PaddedSize.Y; ++Y)
+	{
+		const uint8* SourceRow = Pixels.GetData() + (SIZE_T)FMath::Min(Y, Height - 1) * Width * 4;
+		uint8* DestRow = PaddedPixels.GetData() + (SIZE_T)Y * PaddedSize.X * 4;
+		FMemory::Memcpy(DestRow, SourceRow, Width * 4);
+		for (int X = Width; X < PaddedSize.X; ++X)
+		{
+			FMemory::Memcpy(DestRow + X * 4, SourceRow + (Width - 1) * 4, 4);
+		}
+	}
+
+	Width = PaddedSize.X;
+	Height = PaddedSize.Y;
+	Pixels = MoveTemp(PaddedPixels);
+}
+
+void FPageCompressor::CompressBC1(const uint8* Pixels, int Width, int Height, TArray<uint8>& OutBlocks)
+{
+	const int NumBlocksX = FMath::DivideAndRoundUp(Width, 4);
+	const int NumBlocksY = FMath::DivideAndRoundUp(Height, 4);
+	OutBlocks.SetNumUninitialized(NumBlocksX * NumBlocksY * 8);
+
+	ParallelFor(NumBlocksY, [Pixels, Width, Height, NumBlocksX, &OutBlocks](int32 BlockY)
+	{
+		uint8 Colors[16][3];
+		for (int BlockX = 0; BlockX < NumBlocksX; ++BlockX)
+		{
+			// はみ出した部分は端の画素を繰り返す
+			for (int Index = 0; Index < 16; ++Index)
+			{
+				const int X = FMath::Min(BlockX * 4 + (Index & 3), Width - 1);
+				const int Y = FMath::Min(BlockY * 4 + (Index >> 2), Height - 1);
+				const uint8* Pixel = Pixels + ((SIZE_T)Y * Width + X) * 4;
+				Colors[Index][0] = Pixel[2];
+				Colors[Index][1] = Pixel[1];
+				Colors[Index][2] = Pixel[0];
+			}
+
+			CompressBlockBC1(Colors, OutBlocks.GetData() + ((SIZE_T)BlockY * NumBlocksX + BlockX) * 8);
+		}
+	});
+}
+
+void FPageCompressor::CompressBlockBC1(const uint8 (&Colors)[16][3], uint8* OutBlock)
+{
+	// 色の広がりが最も大きい軸を求める
+	float Mean[3] = { 0.0f, 0.0f, 0.0f };
+	for (int Index = 0; Index < 16; ++Index)
+	{
+		for (int Channel = 0; Channel < 3; ++Channel)
+		{
+			Mean[Channel] += Colors[Index][Channel] / 16.0f;
+		}
+	}
+
+	float Covariance[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+	for (int Index = 0; Index < 16; ++Index)
+	{
+		const float R = Colors[Index][0] - Mean[0];
+		const float G = Colors[Index][1] - Mean[1];
+		const float B = Colors[Index][2] - Mean[2];
+		Covariance[0] += R * R;
+		Covariance[1] += R * G;
+		Covariance[2] += R * B;
+		Covariance[3] += G * G;
+		Covariance[4] += G * B;
+		Covariance[5] += B * B;
+	}
+
+	// 反復法で主軸を近似する（単色のブロックでは輝度の方向のまま）
+	float Axis[3] = { 0.299f, 0.587f, 0.114f };
+	for (int Iteration = 0; Iteration < 4; ++Iteration)
+	{
+		const float X = Covariance[0] * Axis[0] + Covariance[1] * Axis[1] + Covariance[2] * Axis[2];
+		const float Y = Covariance[1] * Axis[0] + Covariance[3] * Axis[1] + Covariance[4] * Axis[2];
+		const float Z = Covariance[2] * Axis[0] + Covariance[4] * Axis[1] + Covariance[5] * Axis[2];
+		const float Length = FMath::Max3(FMath::Abs(X), FMath::Abs(Y), FMath::Abs(Z));
+		if (Length < KINDA_SMALL_NUMBER)
+		{
+			break;
+		}
+		Axis[0] = X / Length;
+		Axis[1] = Y / Length;
+		Axis[2] = Z / Length;
+	}
+
+	// 軸の両端にある色を端点にする
+	int MinIndex = 0;
+	int MaxIndex = 0;
+	float MinProjection = MAX_flt;
+	float MaxProjection = -MAX_flt;
+	for (int Index = 0; Index < 16; ++Index)
+	{
+		const float Projection = Colors[Index][0] * Axis[0] + Colors[Index][1] * Axis[1] + Colors[Index][2] * Axis[2];
+		if (Projection < MinProjection)
+		{
+			MinProjection = Projection;
+			MinIndex = Index;
+		}
+		if (Projection > MaxProjection)
+		{
+			MaxProjection = Projection;
+			MaxIndex = Index;
+		}
+	}
+
+	const float MaxColor[3] = { (float)Colors[MaxIndex][0], (float)Colors[MaxIndex][1], (float)Colors[MaxIndex][2] };
+	const float MinColor[3] = { (float)Colors[MinIndex][0], (float)Colors[MinIndex][1], (float)Colors[MinIndex][2] };
+	uint16 Color0 = PackRGB565(MaxColor);
+	uint16 Color1 = PackRGB565(MinColor);
+
+	// 4色のモードにするためColor0の方を大きくする
+	if (Color0 < Color1)
+	{
+		Swap(Color0, Color1);
+	}
+
+	uint32 Indices = 0;
+	if (Color0 != Color1)
+	{
+		int Palette[4][3];
+		UnpackRGB565(Color0, Palette[0]);
+		UnpackRGB565(Color1, Palette[1]);
+		for (int Channel = 0; Channel < 3; ++Channel)
+		{
+			Palette[2][Channel] = (2 * Palette[0][Channel] + Palette[1][Channel]) / 3;
+			Palette[3][Channel] = (Palette[0][Channel] + 2 * Palette[1][Channel]) / 3;
+		}
+
+		// 各画素に最も近いパレットの色を選ぶ
+		for (int Index = 0; Index < 16; ++Index)
+		{
+			int BestEntry = 0;
+			int BestDistance = MAX_int32;
+			for (int Entry = 0; Entry < 4; ++Entry)
+			{
+				const int R = Colors[Index][0] - Palette[Entry][0];
+				const int G = Colors[Index][1] - Palette[Entry][1];
+				const int B = Colors[Index][2] - Palette[Entry][2];
+				const int Distance = R * R + G * G + B * B;
+				if (Distance < BestDistance)
+				{
+					BestDistance = Distance;
+					BestEntry = Entry;
+				}
+			}
+			Indices |= (uint32)BestEntry << (Index * 2);
+		}
+	}
+
+	// リトルエンディアンで端点2色と2bitずつの番号を並べる
+	OutBlock[0] = (uint8)(Color0 & 0xFF);
+	OutBlock[1] = (uint8)(Color0 >> 8);
+	OutBlock[2] = (uint8)(Color1 & 0xFF);
+	OutBlock[3] = (uint8)(Color1 >> 8);
+	OutBlock[4] = (uint8)(Indices & 0xFF);
+	OutBlock[5] = (uint8)((Indices >> 8) & 0xFF);
+	OutBlock[6] = (uint8)((Indices >> 16) & 0xFF);
+	OutBlock[7] = (uint8)(Indices >> 24);
+}
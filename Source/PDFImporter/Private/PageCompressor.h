@@ -0,0 +1,22 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Encodes BGRA pages into block compressed texture data at runtime, where the texture compressors of the editor are not available
+class FPageCompressor
+{
+public:
+	// Get the size of the texture that holds a page, rounded up to whole 4x4 blocks
+	static FIntPoint GetPaddedSize(int Width, int Height);
+
+	// Pad BGRA8 pixels to whole 4x4 blocks by repeating the last row and column, so that the mips are built from the padded size
+	static void PadToBlocks(int& Width, int& Height, TArray<uint8>& Pixels);
+
+	// Encode BGRA8 pixels into BC1 (DXT1) blocks of the padded size, repeating the last row and column into the padding
+	// Rows of blocks are encoded in parallel, and alpha is ignored as pages are opaque
+	static void CompressBC1(const uint8* Pixels, int Width, int Height, TArray<uint8>& OutBlocks);
+
+private:
+	// Encode the 16 RGB colors of a block into 8 bytes
+	static void CompressBlockBC1(const uint8 (&Colors)[16][3], uint8* OutBlock);
+};
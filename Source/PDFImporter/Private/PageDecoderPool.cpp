@@ -0,0 +1,89 @@
+#include "PageDecoderPool.h"
+#include "PDFImporter.h"
+#include "RawPageFile.h"
+#include "Misc/Paths.h"
+#include "Misc/FileHelper.h"
+#include "Misc/ScopeLock.h"
+#include "Modules/ModuleManager.h"
+#include "IImageWrapperModule.h"
+#include "IImageWrapper.h"
+
+FPageDecoderPool::FPageDecoderPool()
+	: ImageWrapperModule(FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper")))
+{
+}
+
+bool FPageDecoderPool::Decode(const FString& FilePath, int& OutWidth, int& OutHeight, TArray<uint8>& OutPixels)
+{
+	// 非圧縮の画像はデコーダーを使わずに行ごとにコピーする
+	if (!FPaths::GetExtension(FilePath).Equals(TEXT("jpg"), ESearchCase::IgnoreCase))
+	{
+		FRawPageFile RawPageFile;
+		if (!RawPageFile.Open(FilePath))
+		{
+			return false;
+		}
+
+		OutWidth = RawPageFile.GetWidth();
+		OutHeight = RawPageFile.GetHeight();
+
+		// ページの大きさによっては配列に収まらない
+		const int64 NumBytes = (int64)OutWidth * OutHeight * 4;
+		if (NumBytes > MAX_int32)
+		{
+			UE_LOG(PDFImporter, Error, TEXT("%s (%dx%d) is too large to load into memory"), *FilePath, OutWidth, OutHeight);
+			return false;
+		}
+		OutPixels.SetNumUninitialized((int32)NumBytes);
+		RawPageFile.CopyToBGRA(OutPixels.GetData());
+		return true;
+	}
+
+	// 画像データを読み込む
+	TArray<uint8> RawFileData;
+	if (!FFileHelper::LoadFileToArray(RawFileData, *FilePath))
+	{
+		return false;
+	}
+
+	// デコーダーは他のスレッドと共有しない
+	TSharedPtr<IImageWrapper> Decoder = AcquireDecoder();
+	bool bResult = false;
+	const TArray<uint8>* UncompressedRawData = nullptr;
+	if (Decoder.IsValid() &&
+		Decoder->SetCompressed(RawFileData.GetData(), RawFileData.Num()) &&
+		Decoder->GetRaw(ERGBFormat::BGRA, 8, UncompressedRawData)
+		)
+	{
+		// デコーダーの中のバッファは次のページで上書きされるので返す前にコピーする
+		OutWidth = Decoder->GetWidth();
+		OutHeight = Decoder->GetHeight();
+		OutPixels = *UncompressedRawData;
+		bResult = true;
+	}
+	ReleaseDecoder(Decoder);
+
+	return bResult;
+}
+
+TSharedPtr<IImageWrapper> FPageDecoderPool::AcquireDecoder()
+{
+	{
+		FScopeLock Lock(&IdleDecodersLock);
+		if (IdleDecoders.Num() > 0)
+		{
+			return IdleDecoders.Pop(false);
+		}
+	}
+
+	return ImageWrapperModule.CreateImageWrapper(EImageFormat::JPEG);
+}
+
+void FPageDecoderPool::ReleaseDecoder(TSharedPtr<IImageWrapper> Decoder)
+{
+	if (Decoder.IsValid())
+	{
+		FScopeLock Lock(&IdleDecodersLock);
+		IdleDecoders.Add(Decoder);
+	}
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Decodes page image files into BGRA pixels from any thread
+// Each decoding borrows a JPEG decoder of its own from the pool, so that the pages of a document can be decoded in parallel
+class FPageDecoderPool
+{
+private:
+	// Creates the JPEG decoders
+	class IImageWrapperModule& ImageWrapperModule;
+
+	// Decoders waiting for the next page
+	TArray<TSharedPtr<class IImageWrapper>> IdleDecoders;
+	FCriticalSection IdleDecodersLock;
+
+public:
+	// Constructor
+	// Call on the game thread, which loads the image wrapper module
+	FPageDecoderPool();
+
+	// Decode a jpg file, or an uncompressed file written by Ghostscript or the render cache, into BGRA8 pixels
+	bool Decode(const FString& FilePath, int& OutWidth, int& OutHeight, TArray<uint8>& OutPixels);
+
+private:
+	// Take an idle decoder, or create one when all of them are in use
+	TSharedPtr<class IImageWrapper> AcquireDecoder();
+
+	// Return a decoder to the pool
+	void ReleaseDecoder(TSharedPtr<class IImageWrapper> Decoder);
+};
@@ -0,0 +1,164 @@
+#include "PageMipGenerator.h"
+#include "Async/ParallelFor.h"
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS_NEON
+#include <arm_neon.h>
+#elif PLATFORM_ENABLE_VECTORINTRINSICS
+#include <emmintrin.h>
+#endif
+
+int FPageMipGenerator::GetNumMips(int Width, int Height)
+{
+	if (Width <= 0 || Height <= 0)
+	{
+		return 0;
+	}
+
+	return FMath::FloorLog2(FMath::Max(Width, Height)) + 1;
+}
+
+FIntPoint FPageMipGenerator::GetMipSize(int Width, int Height, int MipIndex)
+{
+	return FIntPoint(FMath::Max(Width >> MipIndex, 1), FMath::Max(Height >> MipIndex, 1));
+}
+
+int64 FPageMipGenerator::GetMipChainSize(int Width, int Height)
+{
+	int64 ChainBytes = 0;
+	const int NumMips = GetNumMips(Width, Height);
+	for (int MipIndex = 0; MipIndex < NumMips; ++MipIndex)
+	{
+		const FIntPoint MipSize = GetMipSize(Width, Height, MipIndex);
+		ChainBytes += (int64)MipSize.X * MipSize.Y * 4;
+	}
+
+	return ChainBytes;
+}
+
+int FPageMipGenerator::GenerateMipChain(int Width, int Height, TArray<uint8>& Pixels)
+{
+	const int NumMips = GetNumMips(Width, Height);
+	if (NumMips == 0 || Pixels.Num() != (int64)Width * Height * 4)
+	{
+		return 0;
+	}
+
+	// 全てのミップが収まる大きさを先に確保して、コピーし直さないようにする
+	const int64 ChainBytes = GetMipChainSize(Width, Height);
+	if (ChainBytes > MAX_int32)
+	{
+		return 1;
+	}
+	Pixels.SetNumUninitialized((int32)ChainBytes);
+
+	DownsampleChain(Width, Height, NumMips, Pixels.GetData());
+	return NumMips;
+}
+
+int FPageMipGenerator::GenerateMipChain(int Width, int Height, TArray64<uint8>& Pixels)
+{
+	const int NumMips = GetNumMips(Width, Height);
+	if (NumMips == 0 || Pixels.Num() != (int64)Width * Height * 4)
+	{
+		return 0;
+	}
+
+	Pixels.SetNumUninitialized(GetMipChainSize(Width, Height));
+
+	DownsampleChain(Width, Height, NumMips, Pixels.GetData());
+	return NumMips;
+}
+
+void FPageMipGenerator::DownsampleChain(int Width, int Height, int NumMips, uint8* Pixels)
+{
+	// 一つ上のミップから順に縮小する
+	int64 SourceOffset = 0;
+	for (int MipIndex = 1; MipIndex < NumMips; ++MipIndex)
+	{
+		const FIntPoint SourceSize = GetMipSize(Width, Height, MipIndex - 1);
+		const int64 DestOffset = SourceOffset + (int64)SourceSize.X * SourceSize.Y * 4;
+		Downsample(Pixels + SourceOffset, SourceSize.X, SourceSize.Y, Pixels + DestOffset);
+		SourceOffset = DestOffset;
+	}
+}
+
+void FPageMipGenerator::Downsample(const uint8* Source, int Width, int Height, uint8* Dest)
+{
+	const FIntPoint DestSize = GetMipSize(Width, Height, 1);
+
+	// 小さいミップはスレッドに分けるほどの量がない
+	const int RowsPerTask = FMath::Max(1, 16384 / FMath::Max(DestSize.X, 1));
+	const int NumTasks = FMath::DivideAndRoundUp(DestSize.Y, RowsPerTask);
+	ParallelFor(NumTasks, [Source, Width, Height, Dest, DestSize, RowsPerTask](int32 TaskIndex)
+	{
+		const int EndY = FMath::Min((TaskIndex + 1) * RowsPerTask, DestSize.Y);
+		for (int Y = TaskIndex * RowsPerTask; Y < EndY; ++Y)
+		{
+			// 高さが1の場合は同じ行を2回使う
+			const uint8* Row0 = Source + (SIZE_T)FMath::Min(Y * 2, Height - 1) * Width * 4;
+			const uint8* Row1 = Source + (SIZE_T)FMath::Min(Y * 2 + 1, Height - 1) * Width * 4;
+			DownsampleRow(Row0, Row1, Width, Dest + (SIZE_T)Y * DestSize.X * 4, DestSize.X);
+		}
+	}, NumTasks == 1);
+}
+
+void FPageMipGenerator::DownsampleRow(const uint8* Row0, const uint8* Row1, int SourceWidth, uint8* DestRow, int DestWidth)
+{
+	int X = 0;
+
+	// 幅が1の列は同じ画素を2回使うので、ベクトル化するのは2画素ずつ揃っている場合だけ
+	if (SourceWidth >= 2)
+	{
+#if PLATFORM_ENABLE_VECTORINTRINSICS_NEON
+		// 4画素を読んで2画素を書き込む
+		for (; X + 2 <= DestWidth; X += 2)
+		{
+			const uint8x16_t Top = vld1q_u8(Row0 + X * 8);
+			const uint8x16_t Bottom = vld1q_u8(Row1 + X * 8);
+
+			// 縦に足してから隣の画素と足す
+			const uint16x8_t Left = vaddl_u8(vget_low_u8(Top), vget_low_u8(Bottom));
+			const uint16x8_t Right = vaddl_u8(vget_high_u8(Top), vget_high_u8(Bottom));
+			const uint16x4_t Pixel0 = vadd_u16(vget_low_u16(Left), vget_high_u16(Left));
+			const uint16x4_t Pixel1 = vadd_u16(vget_low_u16(Right), vget_high_u16(Right));
+
+			// 4で割って四捨五入する
+			vst1_u8(DestRow + X * 4, vrshrn_n_u16(vcombine_u16(Pixel0, Pixel1), 2));
+		}
+#elif PLATFORM_ENABLE_VECTORINTRINSICS
+		// 8画素を読んで4画素を書き込む
+		const __m128i Zero = _mm_setzero_si128();
+		const __m128i Rounding = _mm_set1_epi16(2);
+		for (; X + 4 <= DestWidth; X += 4)
+		{
+			__m128i Averages[2];
+			for (int Half = 0; Half < 2; ++Half)
+			{
+				const __m128i Top = _mm_loadu_si128((const __m128i*)(Row0 + X * 8 + Half * 16));
+				const __m128i Bottom = _mm_loadu_si128((const __m128i*)(Row1 + X * 8 + Half * 16));
+
+				// 縦に足してから隣の画素と足す
+				const __m128i Left = _mm_add_epi16(_mm_unpacklo_epi8(Top, Zero), _mm_unpacklo_epi8(Bottom, Zero));
+				const __m128i Right = _mm_add_epi16(_mm_unpackhi_epi8(Top, Zero), _mm_unpackhi_epi8(Bottom, Zero));
+				const __m128i Pixel0 = _mm_add_epi16(Left, _mm_srli_si128(Left, 8));
+				const __m128i Pixel1 = _mm_add_epi16(Right, _mm_srli_si128(Right, 8));
+
+				// 4で割って四捨五入する
+				Averages[Half] = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(Pixel0, Pixel1), Rounding), 2);
+			}
+			_mm_storeu_si128((__m128i*)(DestRow + X * 4), _mm_packus_epi16(Averages[0], Averages[1]));
+		}
+#endif
+	}
+
+	// 残りの画素
+	for (; X < DestWidth; ++X)
+	{
+		const int X0 = FMath::Min(X * 2, SourceWidth - 1) * 4;
+		const int X1 = FMath::Min(X * 2 + 1, SourceWidth - 1) * 4;
+		for (int Channel = 0; Channel < 4; ++Channel)
+		{
+			DestRow[X * 4 + Channel] = (uint8)((Row0[X0 + Channel] + Row0[X1 + Channel] + Row1[X0 + Channel] + Row1[X1 + Channel] + 2) >> 2);
+		}
+	}
+}
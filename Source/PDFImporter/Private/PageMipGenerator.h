@@ -0,0 +1,34 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Builds the mip chain of BGRA pages with a 2x2 box filter, using SSE2 or NEON where available
+// Each level is half the size of the previous one rounded down, down to 1x1, the same sizes the engine expects
+class FPageMipGenerator
+{
+public:
+	// Get the number of mips of a full chain for the size of the top mip
+	static int GetNumMips(int Width, int Height);
+
+	// Get the size of a mip in the chain of the size of the top mip
+	static FIntPoint GetMipSize(int Width, int Height, int MipIndex);
+
+	// Get the size in bytes of a full chain of BGRA8 mips
+	static int64 GetMipChainSize(int Width, int Height);
+
+	// Append the lower mips of a full chain after the BGRA8 pixels of the top mip, and return the number of mips
+	// Only the top mip is kept when the chain would not fit in the array
+	static int GenerateMipChain(int Width, int Height, TArray<uint8>& Pixels);
+	static int GenerateMipChain(int Width, int Height, TArray64<uint8>& Pixels);
+
+	// Write the next mip of BGRA8 pixels into Dest, which holds the pixels of GetMipSize(Width, Height, 1)
+	// Rows are downsampled in parallel
+	static void Downsample(const uint8* Source, int Width, int Height, uint8* Dest);
+
+private:
+	// Downsample each mip of a chain whose top mip is filled into the next one
+	static void DownsampleChain(int Width, int Height, int NumMips, uint8* Pixels);
+
+	// Average two rows of the source into one row of the next mip
+	static void DownsampleRow(const uint8* Row0, const uint8* Row1, int SourceWidth, uint8* DestRow, int DestWidth);
+};
@@ -0,0 +1,209 @@
+#include "RawPageFile.h"
+#include "PDFImporter.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Async/MappedFileHandle.h"
+#include "Misc/FileHelper.h"
+
+FRawPageFile::FRawPageFile()
+	: Data(nullptr), DataSize(0)
+	, Width(0), Height(0), BytesPerPixel(0), PixelOffset(0), RowPitch(0)
+	, bIsBottomUp(false), bIsBGR(false)
+{
+}
+
+FRawPageFile::~FRawPageFile()
+{
+	// マップした領域はハンドルより先に解放する
+	MappedRegion.Reset();
+	MappedFile.Reset();
+}
+
+bool FRawPageFile::Open(const FString& FilePath)
+{
+	// ファイルをメモリにマップする
+	MappedFile.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*FilePath));
+	if (MappedFile.IsValid())
+	{
+		MappedRegion.Reset(MappedFile->MapRegion());
+	}
+
+	if (MappedRegion.IsValid())
+	{
+		Data = MappedRegion->GetMappedPtr();
+		DataSize = MappedRegion->GetMappedSize();
+	}
+	else
+	{
+		// マップできないプラットフォームでは読み込む
+		if (!FFileHelper::LoadFileToArray(FileData, *FilePath))
+		{
+			UE_LOG(PDFImporter, Error, TEXT("Failed to read %s"), *FilePath);
+			return false;
+		}
+		Data = FileData.GetData();
+		DataSize = FileData.Num();
+	}
+
+	bool bResult = false;
+	if (DataSize >= 2 && Data[0] == 'P')
+	{
+		bResult = ParsePortableAnymap();
+	}
+	else if (DataSize >= 2 && Data[0] == 'B' && Data[1] == 'M')
+	{
+		bResult = ParseBitmap();
+	}
+
+	// ヘッダーが示すサイズ分のデータがあるか確認（掛け算があふれないように割って比べる）
+	if (!bResult || Width <= 0 || Height <= 0 || BytesPerPixel <= 0 || PixelOffset < 0 || PixelOffset > DataSize ||
+		RowPitch < (int64)Width * BytesPerPixel || RowPitch > (DataSize - PixelOffset) / Height)
+	{
+		UE_LOG(PDFImporter, Error, TEXT("Unsupported or truncated page image : %s"), *FilePath);
+		return false;
+	}
+
+	return true;
+}
+
+bool FRawPageFile::ParsePortableAnymap()
+{
+	if (Data[1] == '6')
+	{
+		BytesPerPixel = 3;
+	}
+	else if (Data[1] == '5')
+	{
+		BytesPerPixel = 1;
+	}
+	else
+	{
+		return false;
+	}
+
+	// 幅、高さ、最大値の3つの数値を読む（#から行末まではコメント）
+	int Values[3] = { 0, 0, 0 };
+	int64 Offset = 2;
+	for (int& Value : Values)
+	{
+		while (Offset < DataSize && (FChar::IsWhitespace(Data[Offset]) || Data[Offset] == '#'))
+		{
+			if (Data[Offset] == '#')
+			{
+				while (Offset < DataSize && Data[Offset] != '\n')
+				{
+					++Offset;
+				}
+			}
+			++Offset;
+		}
+
+		if (Offset >= DataSize || !FChar::IsDigit(Data[Offset]))
+		{
+			return false;
+		}
+
+		while (Offset < DataSize && FChar::IsDigit(Data[Offset]))
+		{
+			// 壊れたヘッダーの大きな値はあふれる前に弾く
+			const int Digit = Data[Offset] - '0';
+			if (Value > (MAX_int32 - Digit) / 10)
+			{
+				return false;
+			}
+			Value = Value * 10 + Digit;
+			++Offset;
+		}
+	}
+
+	// 16bitのデータには対応しない
+	if (Values[2] != 255)
+	{
+		return false;
+	}
+
+	// 最大値の直後の空白1文字の次からピクセルデータ
+	Width = Values[0];
+	Height = Values[1];
+	PixelOffset = Offset + 1;
+	RowPitch = (int64)Width * BytesPerPixel;
+	bIsBottomUp = false;
+	bIsBGR = false;
+
+	return true;
+}
+
+bool FRawPageFile::ParseBitmap()
+{
+	// BITMAPFILEHEADER(14バイト) + BITMAPINFOHEADER(40バイト)
+	if (DataSize < 54)
+	{
+		return false;
+	}
+
+	auto ReadInt32 = [this](int64 Offset) { return (int32)((uint32)Data[Offset] | ((uint32)Data[Offset + 1] << 8) | ((uint32)Data[Offset + 2] << 16) | ((uint32)Data[Offset + 3] << 24)); };
+	auto ReadInt16 = [this](int64 Offset) { return (int16)(Data[Offset] | (Data[Offset + 1] << 8)); };
+
+	// 非圧縮の24bitと32bit（レンダーキャッシュのページ）のみ対応
+	const int16 BitCount = ReadInt16(28);
+	if ((BitCount != 24 && BitCount != 32) || ReadInt32(30) != 0)
+	{
+		return false;
+	}
+
+	const int32 BitmapHeight = ReadInt32(22);
+	Width = ReadInt32(18);
+	Height = FMath::Abs(BitmapHeight);
+	BytesPerPixel = BitCount / 8;
+	PixelOffset = ReadInt32(10);
+	RowPitch = Align((int64)Width * BytesPerPixel, 4);
+	bIsBottomUp = (BitmapHeight > 0);
+	bIsBGR = true;
+
+	return true;
+}
+
+void FRawPageFile::CopyToBGRA(uint8* Dest) const
+{
+	for (int Y = 0; Y < Height; ++Y)
+	{
+		const uint8* Src = Data + PixelOffset + RowPitch * (bIsBottomUp ? Height - 1 - Y : Y);
+		uint8* DestRow = Dest + (int64)Width * 4 * Y;
+
+		if (BytesPerPixel == 1)
+		{
+			for (int X = 0; X < Width; ++X)
+			{
+				DestRow[0] = DestRow[1] = DestRow[2] = Src[X];
+				DestRow[3] = 0xFF;
+				DestRow += 4;
+			}
+		}
+		else if (BytesPerPixel == 4)
+		{
+			// BGRAの行はそのままコピーできる
+			FMemory::Memcpy(DestRow, Src, (int64)Width * 4);
+		}
+		else if (bIsBGR)
+		{
+			for (int X = 0; X < Width; ++X, Src += 3)
+			{
+				DestRow[0] = Src[0];
+				DestRow[1] = Src[1];
+				DestRow[2] = Src[2];
+				DestRow[3] = 0xFF;
+				DestRow += 4;
+			}
+		}
+		else
+		{
+			for (int X = 0; X < Width; ++X, Src += 3)
+			{
+				DestRow[0] = Src[2];
+				DestRow[1] = Src[1];
+				DestRow[2] = Src[0];
+				DestRow[3] = 0xFF;
+				DestRow += 4;
+			}
+		}
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Page image written by one of the uncompressed Ghostscript devices (ppmraw, pgmraw, bmp16m) or by the render cache
+// The file is memory mapped and its rows are copied straight into texture memory
+class FRawPageFile
+{
+private:
+	// Mapped file, or the file contents when mapping is not supported
+	TUniquePtr<class IMappedFileHandle> MappedFile;
+	TUniquePtr<class IMappedFileRegion> MappedRegion;
+	TArray<uint8> FileData;
+
+	const uint8* Data;
+	int64 DataSize;
+
+	// Layout of the pixel data
+	int Width;
+	int Height;
+	int BytesPerPixel;
+	int64 PixelOffset;
+	int64 RowPitch;
+	bool bIsBottomUp;
+	bool bIsBGR;
+
+public:
+	// Constructor
+	FRawPageFile();
+
+	// Destructor
+	~FRawPageFile();
+
+	// Map the file and parse its header
+	bool Open(const FString& FilePath);
+
+	int GetWidth() const { return Width; }
+	int GetHeight() const { return Height; }
+
+	// Write the pixels as BGRA8, top row first, to a buffer of Width * Height * 4 bytes
+	void CopyToBGRA(uint8* Dest) const;
+
+private:
+	// Parse the header of the binary PPM (P6) and PGM (P5) formats
+	bool ParsePortableAnymap();
+
+	// Parse the header of 24bit and 32bit uncompressed BMP
+	bool ParseBitmap();
+};
@@ -0,0 +1,71 @@
+#include "Windows/WindowsGhostscriptRasterizer.h"
+
+#if PLATFORM_WINDOWS
+
+#include "Misc/Paths.h"
+
+#include "AllowWindowsPlatformTypes.h"
+#include <Windows.h>
+#include "HideWindowsPlatformTypes.h"
+
+TArray<FString> FWindowsGhostscriptRasterizer::GetLibraryPaths() const
+{
+	// dllファイルのパスを取得
+	FString GhostscriptDllPath = FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectPluginsDir(), TEXT("PDFImporter"), TEXT("ThirdParty")));
+#ifdef _WIN64
+	GhostscriptDllPath = FPaths::Combine(GhostscriptDllPath, TEXT("Win64"));
+#elif _WIN32
+	GhostscriptDllPath = FPaths::Combine(GhostscriptDllPath, TEXT("Win32"));
+#endif
+	GhostscriptDllPath = FPaths::Combine(GhostscriptDllPath, TEXT("gsdll.dll"));
+
+	return TArray<FString>{ GhostscriptDllPath };
+}
+
+TArray<char> FWindowsGhostscriptRasterizer::FStringToCharPtr(const FString& Text) const
+{
+	int Size = GetFStringSize(Text) + 1;
+	TArray<char> Buffer("", Size);
+	WideCharToMultiByte(CP_ACP, 0, *Text, Size, Buffer.GetData(), Buffer.Num(), NULL, NULL);
+	return Buffer;
+}
+
+int FWindowsGhostscriptRasterizer::GetFStringSize(const FString& InString)
+{
+	int Size = 0;
+
+	for (TCHAR Char : InString)
+	{
+		const char* Temp = TCHAR_TO_UTF8(*FString::Chr(Char));
+		uint8 Code = static_cast<uint8>(*Temp);
+
+		if ((Code >= 0x00) && (Code <= 0x7f))
+		{
+			Size += 1;
+		}
+		else if ((Code >= 0xc2) && (Code <= 0xdf))
+		{
+			Size += 2;
+		}
+		else if ((Code >= 0xe0) && (Code <= 0xef))
+		{
+			Size += 3;
+		}
+		else if ((Code >= 0xf0) && (Code <= 0xf7))
+		{
+			Size += 4;
+		}
+		else if ((Code >= 0xf8) && (Code <= 0xfb))
+		{
+			Size += 5;
+		}
+		else if ((Code >= 0xfc) && (Code <= 0xfd))
+		{
+			Size += 6;
+		}
+	}
+
+	return Size;
+}
+
+#endif
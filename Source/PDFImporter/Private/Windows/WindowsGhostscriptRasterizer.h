@@ -0,0 +1,22 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GhostscriptRasterizer.h"
+
+#if PLATFORM_WINDOWS
+
+// Ghostscript backend that loads gsdll.dll bundled with the plugin
+class FWindowsGhostscriptRasterizer : public FGhostscriptRasterizer
+{
+protected:
+	// FGhostscriptRasterizer interface
+	virtual TArray<FString> GetLibraryPaths() const override;
+	virtual TArray<char> FStringToCharPtr(const FString& Text) const override;
+	// End of FGhostscriptRasterizer interface
+
+private:
+	// Get the size of FString data
+	static int GetFStringSize(const FString& Text);
+};
+
+#endif
@@ -4,10 +4,13 @@
 
 #include "CoreMinimal.h"
 #include "Kismet/BlueprintAsyncActionBase.h"
+#include "PDF.h"
+#include "PDFConversionToken.h"
 #include "ConvertPdfToPdfAsset.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FLoadingCompletedPin, class UPDF*, PDF);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FFailedToLoadPin);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FPageReadyPin, int, PageIndex, class UTexture2D*, Page);
 
 UCLASS()
 class PDFIMPORTER_API UConvertPdfToPdfAsset : public UBlueprintAsyncActionBase
@@ -19,20 +22,42 @@ public:
 	UPROPERTY(BlueprintAssignable)
 	FLoadingCompletedPin Completed;
 
+	// Execution pin called for each page as soon as it is loaded, before the rest of the document is done
+	UPROPERTY(BlueprintAssignable)
+	FPageReadyPin OnPageReady;
+
+	// Execution pin called when a page shown by OnPageReady at the preview resolution has been replaced by the full resolution in the same texture
+	UPROPERTY(BlueprintAssignable)
+	FPageReadyPin OnPageRefined;
+
 	// Execution pin called when loading fails
 	UPROPERTY(BlueprintAssignable)
 	FFailedToLoadPin Failed;
 
 private:
-	TSharedPtr<class FGhostscriptCore> GhostscriptCore;
+	TSharedPtr<class FPDFConversionScheduler, ESPMode::ThreadSafe> ConversionScheduler;
 	const UObject* WorldContextObject;
 	bool bIsActive;
 
+	// Reports the progress of the conversion, shared with the nodes that requested the same conversion
+	TSharedPtr<FPDFConversionToken> Token;
+
+	// Handle of the request in the scheduler, used to cancel it
+	uint64 RequestHandle;
+
 	// For argument passing
 	FString PDFFilePath;
 	int Dpi;
 	int FirstPage;
 	int LastPage;
+	EPDFRenderMode RenderMode;
+	EPDFRasterizerBackend Backend;
+	bool bExtractText;
+	int PreviewDpi;
+	EPDFConversionPriority Priority;
+
+	// Pages already passed to OnPageReady
+	TSet<int> ReadyPages;
 
 public:
 	// Constructor
@@ -45,9 +70,23 @@ public:
 		const FString& PDF_FilePath, 
 		int Dpi = 150,
 		int FirstPage = 0,
-		int LastPage = 0
+		int LastPage = 0,
+		EPDFRenderMode RenderMode = EPDFRenderMode::InMemory,
+		EPDFRasterizerBackend Backend = EPDFRasterizerBackend::Ghostscript,
+		bool bExtractText = false,
+		int PreviewDpi = 0,
+		EPDFConversionPriority Priority = EPDFConversionPriority::Interactive
 	);
 
 	// UBlueprintAsyncActionBase interface
 	virtual void Activate() override;
+
+	// Stop the running conversion, after which Failed is called
+	UFUNCTION(BlueprintCallable, Category = "PDFImporter")
+	void Cancel();
+
+	// Get the progress of the running conversion
+	// PagesTotal is 0 while the number of pages is not yet known
+	UFUNCTION(BlueprintPure, Category = "PDFImporter")
+	void GetProgress(int& PagesDone, int& PagesTotal, int64& BytesProcessed) const;
 };
\ No newline at end of file
@@ -2,25 +2,56 @@
 
 #include "CoreMinimal.h"
 #include "PDFImporter.h"
+#include "PDF.h"
+#include "IPDFRasterizer.h"
+#include "PDFConversionToken.h"
 
-typedef int(*CreateAPIInstance)(void** Instance, void* CallerHandle);
-typedef void(*DeleteAPIInstance)(void* Instance);
-typedef int(*InitAPI)(void* Instance, int Argc, char** Argv);
-typedef int(*ExitAPI)(void* Instance);
+// Receives each page texture as soon as it is created, on the thread that called ConvertPdfToPdfAsset
+// With a preview resolution it is called again for the same texture once the page is refined to the full resolution in place
+typedef TFunction<void(int PageIndex, class UTexture2D* Page)> FPDFPageLoadedCallback;
+
+// Page textures of an earlier editor import, kept by a reimport for the pages whose rendered pixels did not change
+struct FPDFReusablePages
+{
+	TArray<class UTexture2D*> Pages;
+
+	// Fingerprint of each of Pages, from UPDF::PageFingerprints
+	TArray<uint64> Fingerprints;
+};
 
 class PDFIMPORTER_API FGhostscriptCore
 {
 private:
-	// Ghostscript module
-	void* GhostscriptModule;
+	// Ghostscript backend for the running platform
+	TSharedPtr<class FGhostscriptRasterizer, ESPMode::ThreadSafe> Ghostscript;
+
+	// Optional PDFium backend, null when the library is not installed
+	TSharedPtr<class FPDFiumRasterizer, ESPMode::ThreadSafe> PDFium;
+
+	// Pages rendered by earlier conversions, null when disabled in the settings
+	TSharedPtr<class FPDFRenderCache> RenderCache;
 
-	// Ghostscript function pointers
-	CreateAPIInstance CreateInstance;
-	DeleteAPIInstance DeleteInstance;
-	InitAPI Init;
-	ExitAPI Exit;
+	// Decoders of the page image files, shared by the threads that decode pages in parallel
+	TSharedPtr<class FPageDecoderPool> DecoderPool;
 
-	TSharedPtr<class IImageWrapper> ImageWrapper;
+	// Creates the runtime page textures on the game thread a few at a time
+	TSharedPtr<class FPDFTextureUploader> TextureUploader;
+
+	// Threads that run the renders of conversions and tiles while the calling thread creates the textures
+	// Renders block their thread until the document is done, so they are kept off the shared thread pool of the engine
+	class FQueuedThreadPool* RenderThreadPool;
+
+	// Encode the runtime page textures to BC1 before they are uploaded
+	bool bCompressRuntimePages;
+
+	// Give the page textures a full mip chain
+	bool bGeneratePageMips;
+
+	// Import the page texture assets as streaming virtual textures
+	bool bImportAsVirtualTextures;
+
+	// Directory that contains the working directory of each conversion
+	FString WorkspaceRoot;
 
 public:
 	// The path to the directory where the page's texture assets are located
@@ -28,29 +59,74 @@ public:
 
 public:
 	// Convert PDF to PDF asset
-	class UPDF* ConvertPdfToPdfAsset(const FString& InputPath, int Dpi, int FirstPage, int LastPage, bool bIsImportIntoEditor = false);
+	// Token keeps the returned asset and its pages alive until the caller releases its objects, which it must do once it references them
+	// When PreviewDpi is greater than 0, in-memory conversions first publish each page rendered at PreviewDpi and then refine the same texture
+	// Editor imports record the fingerprint of each page, and reuse the texture of ReusablePages that has the same fingerprint instead of creating one
+	class UPDF* ConvertPdfToPdfAsset(const FString& InputPath, int Dpi, int FirstPage, int LastPage, EPDFRenderMode RenderMode = EPDFRenderMode::InMemory, EPDFRasterizerBackend Backend = EPDFRasterizerBackend::Ghostscript, bool bIsImportIntoEditor = false, const FPDFPageLoadedCallback& OnPageLoaded = nullptr, FPDFConversionToken* Token = nullptr, int PreviewDpi = 0, const FPDFReusablePages* ReusablePages = nullptr);
+
+	// Read the page count, page sizes and document information of PDF without rasterizing it
+	bool ProbePdf(const FString& InputPath, FPDFDocumentInfo& OutInfo);
+
+	// Extract the text of the pages in the range and build a search index of it
+	bool ExtractText(const FString& InputPath, int FirstPage, int LastPage, FPDFTextIndex& OutIndex, FPDFConversionToken* Token = nullptr);
+
+	// Get the rasterizer of the backend used for in-memory conversion, or nullptr if none is available
+	IPDFRasterizer* GetRasterizer(EPDFRasterizerBackend Backend = EPDFRasterizerBackend::Ghostscript) const;
+
+	// Fail the texture uploads that wait for the game thread, so that the conversions can stop while the module shuts down
+	void StopTextureUploads();
 
 private:
-	// Convert PDF to multiple jpeg images using Ghostscript API
-	bool ConvertPdfToJpeg(const FString& InputPath, const FString& OutputPath, int Dpi, int FirstPage, int LastPage);
+	// Create an empty working directory that belongs to one conversion, or return an empty string on failure
+	FString CreateWorkspace() const;
+
+	// Render the pages as image files in the working directory and load them as textures
+	// The page files are moved to CacheStagingPath afterwards unless it is empty
+	bool LoadPagesFromFile(const FString& InputPath, int Dpi, int FirstPage, int LastPage, EPDFRenderMode RenderMode, bool bIsImportIntoEditor, const FPDFPageLoadedCallback& OnPageLoaded, FPDFConversionToken* Token, const FString& CacheStagingPath, FPDFReusablePages* ReusablePages, TArray<class UTexture2D*>& OutPages, TArray<uint64>& OutFingerprints);
+
+	// Render the pages into memory and create textures from them
+	// The page bitmaps are also written to CacheStagingPath unless it is empty
+	// Pages rendered at PreviewDpi are published first when it is greater than 0, and replaced in place by the full resolution ones
+	// Pages already published are kept when rendering fails partway, so this succeeds with them and bOutIsComplete is false
+	// Only a canceled conversion or one without any rendered page fails
+	bool LoadPagesFromBitmap(const FString& InputPath, int Dpi, int FirstPage, int LastPage, EPDFRasterizerBackend Backend, bool bIsImportIntoEditor, const FPDFPageLoadedCallback& OnPageLoaded, FPDFConversionToken* Token, const FString& CacheStagingPath, int PreviewDpi, FPDFReusablePages* ReusablePages, TArray<class UTexture2D*>& OutPages, TArray<uint64>& OutFingerprints, bool& bOutIsComplete);
+
+	// Load the page image files with the extension in the directory, in the order of their names
+	// The files are decoded in parallel and the textures are created in page order on the calling thread
+	// Files that fail to load are left out, and the remaining pages are published with the index of their file
+	bool LoadPagesFromDirectory(const FString& DirectoryPath, const FString& Extension, const FString& Filename, bool bIsImportIntoEditor, const FPDFPageLoadedCallback& OnPageLoaded, FPDFConversionToken* Token, FPDFReusablePages* ReusablePages, TArray<class UTexture2D*>& OutPages, TArray<uint64>& OutFingerprints);
 
-	// Create UTexture2D from image files in directory
-	bool LoadTexture2DFromFile(const FString& FilePath, class UTexture2D*& LoadedTexture);
+	// Create UTexture2D from BGRA pixel data
+	// Off the game thread this waits until the texture uploader creates the texture in one of the next frames, and Owner keeps it alive
+	bool LoadTexture2DFromBitmap(int Width, int Height, TArray<uint8>&& Pixels, class UTexture2D*& LoadedTexture, EPixelFormat PixelFormat = PF_B8G8R8A8, int NumMips = 1, FPDFConversionToken* Owner = nullptr);
+
+	// Resize a texture created by LoadTexture2DFromBitmap and replace its pixels with pixel data of the same format
+	bool UpdateTexture2DFromBitmap(class UTexture2D* Texture, int Width, int Height, TArray<uint8>&& Pixels, EPixelFormat PixelFormat = PF_B8G8R8A8, int NumMips = 1);
+
+	// Turn BGRA pixels of a runtime page into the mips of its texture as enabled in the settings
+	// Appends the lower mips after the top one, and encodes all of them to BC1, which pads the size to whole blocks
+	void EncodeRuntimePage(int& Width, int& Height, TArray<uint8>& Pixels, EPixelFormat& OutPixelFormat, int& OutNumMips) const;
+
+	// Downsample the locked top mip of a texture from the texture uploader's Allocate into its lower mips, and unlock all of them
+	static void FillLowerMips(class UTexture2D* Texture, const uint8* TopMip);
 
 #if WITH_EDITORONLY_DATA
-	// Create texture asset from image files in directory
-	bool CreateTextureAssetFromFile(const FString& FilePath, class UTexture2D*& LoadedTexture);
-#endif
+	// Create the texture asset of a page from BGRA pixel data, or reuse the one of ReusablePages with the same fingerprint
+	bool CreatePageTextureAsset(const FString& Filename, int PageIndex, int Width, int Height, const TArray<uint8>& Pixels, FPDFReusablePages* ReusablePages, class UTexture2D*& LoadedTexture, uint64& OutFingerprint);
 
-	// 
-	TArray<char> FStringToCharPtr(const FString& Text);
+	// Create texture asset from BGRA pixel data
+	// Each page gets a package of its own, so saving one page does not rewrite the others
+	bool CreateTextureAssetFromBitmap(const FString& Filename, int PageIndex, int Width, int Height, const TArray<uint8>& Pixels, class UTexture2D*& LoadedTexture);
 
-	// Get the size of FString data
-	int GetFStringSize(const FString& Text);
+	// Create texture asset and let WritePixels fill its BGRA mip data
+	bool CreateTextureAssetFromPixels(const FString& Filename, int PageIndex, int Width, int Height, TFunctionRef<void(uint8*)> WritePixels, class UTexture2D*& LoadedTexture);
+#endif
 
 private:
 	// Only PDFImporterModule can create instances
 	friend FPDFImporterModule;
+	friend class FPDFImporterBenchmark;
+	friend class FPDFTilePyramid;
 
 	FGhostscriptCore();
 
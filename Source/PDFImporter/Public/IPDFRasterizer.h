@@ -0,0 +1,89 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FPDFConversionToken;
+
+// Uncompressed BGRA8 image of one page
+struct FPDFPageBitmap
+{
+	int Width;
+	int Height;
+	TArray<uint8> Pixels;
+
+	// Memory from the page buffer allocator that the page was rendered into, in which case Pixels is empty
+	uint8* Buffer;
+
+	FPDFPageBitmap() : Width(0), Height(0), Buffer(nullptr) {}
+
+	// Get the pixels wherever they were rendered
+	const uint8* GetData() const { return Buffer != nullptr ? Buffer : Pixels.GetData(); }
+	int64 GetNumBytes() const { return Buffer != nullptr ? (int64)Width * Height * 4 : Pixels.Num(); }
+
+	// Allocate Pixels for Width and Height, or return false if the page is too large to be held in Pixels
+	bool AllocatePixels()
+	{
+		const int64 NumBytes = (int64)Width * Height * 4;
+		if (NumBytes <= 0 || NumBytes > MAX_int32)
+		{
+			return false;
+		}
+
+		Pixels.SetNumUninitialized((int32)NumBytes);
+		return true;
+	}
+};
+
+// Provides the memory pages are rendered into, so that their pixels are written once, straight to where they are used
+// Both functions are called on the thread that renders the page
+struct FPDFPageBufferAllocator
+{
+	// Get the Width * Height * 4 bytes of a page before it is rendered, or nullptr to let the rasterizer allocate Pixels
+	TFunction<uint8*(int Width, int Height)> Allocate;
+
+	// Give back memory from Allocate whose page was not passed on because the rendering failed
+	TFunction<void(uint8* Buffer)> Release;
+
+	bool IsSet() const { return (bool)Allocate; }
+};
+
+// Receives each page as soon as it is rendered
+// PageIndex is zero based from the first page of the range, and pages may arrive out of order or from multiple threads
+typedef TFunction<void(int PageIndex, FPDFPageBitmap& Page)> FPDFPageRenderedCallback;
+
+// Document kept open by a rasterizer to render many small regions of its pages, such as the tiles of a tile pyramid
+// Keeps the rasterizer alive, and tiles may be rendered from multiple threads at once
+class PDFIMPORTER_API IPDFTileRenderer
+{
+public:
+	virtual ~IPDFTileRenderer() {}
+
+	// Render only Region of a page into a BGRA bitmap of the size of Region
+	// Region is in pixels from the top left of the page at Dpi, and PageSize is the size of the whole page at Dpi
+	// Stops and fails as soon as possible once Token is canceled
+	virtual bool RenderTile(int Page, int Dpi, const FIntRect& Region, const FIntPoint& PageSize, FPDFPageBitmap& OutTile, const FPDFConversionToken* Token) = 0;
+};
+
+// Backend that renders the pages of PDF into bitmaps
+class PDFIMPORTER_API IPDFRasterizer : public TSharedFromThis<IPDFRasterizer, ESPMode::ThreadSafe>
+{
+public:
+	virtual ~IPDFRasterizer() {}
+
+	// Get the name of the backend used in logs
+	virtual FName GetRasterizerName() const = 0;
+
+	// Get the number of pages in PDF, or -1 if it cannot be known without rendering
+	virtual int GetPageCount(const FString& InputPath) = 0;
+
+	// Render the pages in the range into BGRA bitmaps (the whole document if the range is invalid) and pass each of them to OnPageRendered
+	// Stops and fails as soon as possible once Token is canceled
+	// Pages are rendered into the memory from AllocatePageBuffer when it is set
+	virtual bool StreamPdfToBitmap(const FString& InputPath, int Dpi, int FirstPage, int LastPage, const FPDFPageRenderedCallback& OnPageRendered, const FPDFConversionToken* Token, const FPDFPageBufferAllocator& AllocatePageBuffer = FPDFPageBufferAllocator()) = 0;
+
+	// Open PDF to render tiles of its pages, or nullptr if it cannot be opened
+	virtual TSharedPtr<IPDFTileRenderer, ESPMode::ThreadSafe> OpenTileRenderer(const FString& InputPath) = 0;
+
+	// Render the pages in the range into BGRA bitmaps in page order
+	bool ConvertPdfToBitmap(const FString& InputPath, int Dpi, int FirstPage, int LastPage, TArray<FPDFPageBitmap>& OutPages, const FPDFConversionToken* Token = nullptr);
+};
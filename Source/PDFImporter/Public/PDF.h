@@ -3,9 +3,47 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "PDFTextIndex.h"
 #include "UObject/NoExportTypes.h"
 #include "PDF.generated.h"
 
+UENUM(BlueprintType)
+enum class EPDFRenderMode : uint8
+{
+	// Receive raw page bitmaps from the Ghostscript display device
+	InMemory,
+	// Write jpeg files to the working directory and load them back
+	Jpeg,
+	// Write uncompressed ppm files (ppmraw) and copy their rows into the textures
+	Ppm,
+	// Write uncompressed grayscale pgm files (pgmraw) for monochrome documents
+	// pgmraw is used instead of pnggray, whose deflate stream would have to be decoded again,
+	// and ppmraw and bmp16m instead of bitrgb, which has no header to read the page size from
+	Pgm,
+	// Write uncompressed 24bit bmp files (bmp16m)
+	Bmp
+};
+
+UENUM(BlueprintType)
+enum class EPDFRasterizerBackend : uint8
+{
+	// Ghostscript interpreters from the instance pool
+	Ghostscript,
+	// PDFium shared library (falls back to Ghostscript when it is not installed)
+	PDFium
+};
+
+UENUM(BlueprintType)
+enum class EPDFConversionPriority : uint8
+{
+	// Requested by the user, who is waiting for the pages
+	Interactive,
+	// Needed later, such as a batch of documents
+	Background,
+	// Converted ahead in case it is needed, only when nothing else is waiting
+	Prefetch
+};
+
 USTRUCT(BlueprintType)
 struct FPageRange
 {
@@ -22,6 +60,47 @@ public:
 	int LastPage;
 };
 
+USTRUCT(BlueprintType)
+struct FPDFPageInfo
+{
+	GENERATED_BODY()
+
+public:
+	FPDFPageInfo() : MediaBox(ForceInit), CropBox(ForceInit), Rotation(0) {}
+
+	// Page boundary in points (1/72 inch)
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "PageInfo")
+	FBox2D MediaBox;
+
+	// Visible region of the page in points, the same as MediaBox when it is not specified
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "PageInfo")
+	FBox2D CropBox;
+
+	// Clockwise rotation in degrees applied when the page is displayed
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "PageInfo")
+	int Rotation;
+};
+
+USTRUCT(BlueprintType)
+struct FPDFDocumentInfo
+{
+	GENERATED_BODY()
+
+public:
+	FPDFDocumentInfo() : NumPages(0) {}
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "DocumentInfo")
+	int NumPages;
+
+	// Boxes and rotation of each page
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "DocumentInfo")
+	TArray<FPDFPageInfo> Pages;
+
+	// Entries of the document information dictionary (Title, Author, Subject, Creator, Producer, ...)
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "DocumentInfo")
+	TMap<FString, FString> Info;
+};
+
 UCLASS(BlueprintType)
 class PDFIMPORTER_API UPDF : public UObject
 {
@@ -40,11 +119,22 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "PDF")
 	TArray<class UTexture2D*> Pages;
 
+	// Size in pixels of each page, which is rendered at the size of its own CropBox
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "PDF")
+	TArray<FIntPoint> PageSizes;
+
 	// Data for import setting
 #if WITH_EDITORONLY_DATA
 	UPROPERTY(VisibleAnywhere, Instanced, Category = "ImportSettings")
 	class UAssetImportData* AssetImportData;
 #endif
+	// Searchable text of the pages, empty unless text extraction was enabled
+	FPDFTextIndex TextIndex;
+
+	// Hash of the rendered pixels of each page, used by reimport to keep the textures of unchanged pages
+	// Empty for assets converted at runtime and those imported before fingerprints were recorded
+	TArray<uint64> PageFingerprints;
+
 	UPROPERTY()
 	FString Filename;
 
@@ -60,6 +150,21 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "PDF")
 	int GetPageCount() const { return Pages.Num(); }
 
+	// Get the size in pixels of the specified page
+	UFUNCTION(BlueprintCallable, Category = "PDF")
+	FIntPoint GetPageSize(int Page) const;
+
+	// Find the words or phrases that contain Query, ignoring case, with their boxes in pixels of the page textures
+	UFUNCTION(BlueprintCallable, Category = "PDF")
+	TArray<FPDFTextMatch> FindText(const FString& Query) const;
+
+	// Whether the text of the pages was extracted and can be searched
+	UFUNCTION(BlueprintCallable, Category = "PDF")
+	bool HasText() const { return !TextIndex.IsEmpty(); }
+
+	// Record the size of each page texture in PageSizes
+	void UpdatePageSizes();
+
 public:
 	// UObject interface
 	virtual void Serialize(FArchive& Ar) override;
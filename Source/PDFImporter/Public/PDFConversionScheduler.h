@@ -0,0 +1,115 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PDF.h"
+#include "PDFConversionToken.h"
+
+// Settings of a conversion, which identify the requests that can share one job
+struct FPDFConversionRequest
+{
+	FString InputPath;
+	int Dpi;
+	int FirstPage;
+	int LastPage;
+	EPDFRenderMode RenderMode;
+	EPDFRasterizerBackend Backend;
+	bool bExtractText;
+	int PreviewDpi;
+
+	FPDFConversionRequest()
+		: Dpi(0), FirstPage(0), LastPage(0), RenderMode(EPDFRenderMode::InMemory), Backend(EPDFRasterizerBackend::Ghostscript), bExtractText(false), PreviewDpi(0)
+	{}
+
+	// Get the key shared by the requests with the same file and settings
+	FString GetKey() const;
+};
+
+// Receive the results of a scheduled conversion, always on the game thread
+struct FPDFConversionCallbacks
+{
+	// Called for each page as soon as it is loaded, and again when a preview page is refined
+	TFunction<void(int PageIndex, class UTexture2D* Page)> OnPageLoaded;
+
+	// Called once with the converted asset, or nullptr when the conversion failed or was canceled
+	TFunction<void(class UPDF* PDF)> OnFinished;
+};
+
+// Runs the conversions of the module on a bounded number of workers
+// Waiting jobs start in the order of their priority, and a request with the same file and settings as a job
+// that is waiting or running joins that job instead of converting the file again
+class PDFIMPORTER_API FPDFConversionScheduler : public TSharedFromThis<FPDFConversionScheduler, ESPMode::ThreadSafe>
+{
+private:
+	struct FSubscriber
+	{
+		uint64 Handle;
+		FPDFConversionCallbacks Callbacks;
+	};
+
+	struct FJob
+	{
+		FPDFConversionRequest Request;
+		FString Key;
+		EPDFConversionPriority Priority;
+		TSharedRef<FPDFConversionToken> Token;
+
+		// Requests that receive the results of this job
+		TArray<FSubscriber> Subscribers;
+
+		// Pages loaded so far, replayed to the requests that join later
+		// They are kept alive by Token until the result is delivered
+		TArray<TPair<int, class UTexture2D*>> LoadedPages;
+
+		FJob() : Priority(EPDFConversionPriority::Interactive), Token(MakeShared<FPDFConversionToken>()) {}
+	};
+
+	TSharedPtr<class FGhostscriptCore> GhostscriptCore;
+
+	// Threads that run the jobs, never given more jobs than it has threads
+	class FQueuedThreadPool* ThreadPool;
+	int MaxRunningJobs;
+	bool bIsShuttingDown;
+
+	FCriticalSection JobsLock;
+
+	// Jobs that are waiting, for each priority
+	TArray<TSharedPtr<FJob>> WaitingJobs[3];
+
+	// Jobs that are waiting or running, or whose results are not delivered yet, keyed by FPDFConversionRequest::GetKey
+	TMap<FString, TSharedPtr<FJob>> Jobs;
+
+	int NumRunningJobs;
+	uint64 NextHandle;
+
+public:
+	// Constructor
+	// MaxRunningJobs of 0 uses half of the cores
+	FPDFConversionScheduler(TSharedPtr<class FGhostscriptCore> InGhostscriptCore, int InMaxRunningJobs);
+
+	// Destructor
+	// Cancels the jobs and waits for the running ones to stop
+	~FPDFConversionScheduler();
+
+	// Schedule a conversion and return the handle that cancels it
+	// The token of the job reports the progress, and is shared by all requests that joined the job
+	uint64 Schedule(const FPDFConversionRequest& Request, EPDFConversionPriority Priority, const FPDFConversionCallbacks& Callbacks, TSharedPtr<FPDFConversionToken>& OutToken);
+
+	// Stop receiving the results of a request, whose OnFinished is called with nullptr
+	// The job itself is canceled when no other request is waiting for it
+	void Cancel(uint64 Handle);
+
+	int GetMaxRunningJobs() const { return MaxRunningJobs; }
+
+private:
+	// Start waiting jobs while there are idle workers, with JobsLock held
+	void StartWaitingJobs();
+
+	// Convert the file of a job on a worker
+	void RunJob(TWeakPtr<FPDFConversionScheduler, ESPMode::ThreadSafe> WeakThis, TSharedPtr<FJob> Job);
+
+	// Deliver a loaded page to the requests of a job on the game thread
+	void NotifyPageLoaded(TSharedPtr<FJob> Job, int PageIndex, class UTexture2D* Page);
+
+	// Deliver the result of a job to its requests on the game thread
+	void NotifyFinished(TSharedPtr<FJob> Job, class UPDF* PDF);
+};
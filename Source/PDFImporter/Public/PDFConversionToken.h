@@ -0,0 +1,64 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "HAL/ThreadSafeCounter64.h"
+#include "HAL/CriticalSection.h"
+#include "Misc/ScopeLock.h"
+#include "UObject/GCObject.h"
+
+// Shared between the caller and a running conversion to cancel it and observe its progress
+// Also keeps the objects the conversion creates from being garbage collected while only its threads know them
+class FPDFConversionToken : public FGCObject
+{
+private:
+	FThreadSafeBool bIsCanceled;
+
+	// Progress of the conversion
+	FThreadSafeCounter NumPagesDone;
+	FThreadSafeCounter NumPagesTotal;
+	FThreadSafeCounter64 BytesProcessed;
+
+	// Called periodically on the thread that runs the conversion
+	TFunction<void(FPDFConversionToken&)> ProgressHandler;
+
+	// Page textures and the asset created for the conversion, until the caller receives them
+	TArray<UObject*> KeptObjects;
+	FCriticalSection KeptObjectsLock;
+
+public:
+	FPDFConversionToken() : bIsCanceled(false) {}
+
+	// Ask the conversion to stop as soon as possible
+	void Cancel() { bIsCanceled = true; }
+	bool IsCanceled() const { return bIsCanceled; }
+
+	// Get the number of pages converted so far
+	int GetNumPagesDone() const { return NumPagesDone.GetValue(); }
+
+	// Get the number of pages to convert, or 0 while it is not known
+	int GetNumPagesTotal() const { return NumPagesTotal.GetValue(); }
+
+	// Get the size of the page images produced so far
+	int64 GetBytesProcessed() const { return BytesProcessed.GetValue(); }
+
+	// Set the function that is called periodically while the conversion runs
+	void SetProgressHandler(TFunction<void(FPDFConversionToken&)> InProgressHandler) { ProgressHandler = MoveTemp(InProgressHandler); }
+
+	// Functions used by the conversion
+	void SetNumPagesTotal(int InNumPagesTotal) { NumPagesTotal.Set(InNumPagesTotal); }
+	void AddPageDone(int64 PageBytes) { NumPagesDone.Increment(); BytesProcessed.Add(PageBytes); }
+	void NotifyProgress() { if (ProgressHandler) { ProgressHandler(*this); } }
+
+	// Keep an object created for the conversion alive until ReleaseObjects or the destruction of the token
+	// Call on the game thread, or on another thread while garbage collection is blocked
+	void KeepAlive(UObject* Object) { FScopeLock Lock(&KeptObjectsLock); KeptObjects.AddUnique(Object); }
+
+	// Stop keeping the objects of the conversion once the caller references what it needs of them
+	void ReleaseObjects() { FScopeLock Lock(&KeptObjectsLock); KeptObjects.Empty(); }
+
+	// FGCObject interface
+	virtual void AddReferencedObjects(FReferenceCollector& Collector) override { FScopeLock Lock(&KeptObjectsLock); Collector.AddReferencedObjects(KeptObjects); }
+	// End of FGCObject interface
+};
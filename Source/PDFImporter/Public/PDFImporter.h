@@ -10,6 +10,9 @@ private:
 	// An instance with the same life as this module class
 	TSharedPtr<class FGhostscriptCore> GhostscriptCore;
 
+	// Runs the asynchronous conversions with a limited number of workers
+	TSharedPtr<class FPDFConversionScheduler, ESPMode::ThreadSafe> ConversionScheduler;
+
 public:
 	/** IModuleInterface implementation */
 	virtual void StartupModule() override;
@@ -17,6 +20,9 @@ public:
 
 	// Get an instance of GhostscriptCore
 	TSharedPtr<class FGhostscriptCore> GetGhostscriptCore() const { return GhostscriptCore; }
+
+	// Get the scheduler of the asynchronous conversions
+	TSharedPtr<class FPDFConversionScheduler, ESPMode::ThreadSafe> GetConversionScheduler() const { return ConversionScheduler; }
 };
 
 DEFINE_LOG_CATEGORY_STATIC(PDFImporter, Log, All);
\ No newline at end of file
@@ -44,6 +44,10 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "PDFImporter | OpenFileDialog", meta = (AdvancedDisplay = "DefaultPath", DisplayName = "Open PDF Dialog Multiple", ExpandEnumAsExecs = "OutputPin"))
 	static void OpenPDFDialogMultiple(const FString& DefaultPath, EOpenPDFDialogResult& OutputPin, TArray<FString>& FileNames);
 
+	// Get the page count, page sizes and document information of PDF without converting it
+	UFUNCTION(BlueprintCallable, Category = "PDFImporter")
+	static bool ProbePdf(const FString& FilePath, FPDFDocumentInfo& DocumentInfo);
+
 	// Convert FPageRange to FString
 	UFUNCTION(BlueprintPure, meta = (BlueprintAutocast, DisplayName = "ToString(PageRange)", CompactNodeTitle = "->"))
 	static FString ConvertFPageRangeToFString(FPageRange InPageRange);
@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DeveloperSettings.h"
+#include "PDFImporterSettings.generated.h"
+
+UENUM()
+enum class EPDFPageCompression : uint8
+{
+	// Uncompressed BGRA8, 32 bits per pixel
+	None,
+	// BC1 (DXT1) for opaque pages, 4 bits per pixel
+	BC1,
+	// BC7 for sharper text and colors, 8 bits per pixel
+	BC7
+};
+
+UCLASS(config = Game, defaultconfig, meta = (DisplayName = "PDF Importer"))
+class PDFIMPORTER_API UPDFImporterSettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+	// Rendering threads of each Ghostscript interpreter (0: scaled from the cores and the running conversions)
+	UPROPERTY(config, EditAnywhere, Category = "Ghostscript", meta = (ClampMin = 0, UIMin = 0))
+	int NumRenderingThreads;
+
+	// Largest page bitmap in megabytes Ghostscript renders without banding (0: scaled from the DPI and the available memory)
+	UPROPERTY(config, EditAnywhere, Category = "Ghostscript", meta = (ClampMin = 0, UIMin = 0))
+	int MaxBitmapMegabytes;
+
+	// Reuse the pages of a PDF that was already converted with the same settings
+	UPROPERTY(config, EditAnywhere, Category = "Render Cache", meta = (ConfigRestartRequired = true))
+	bool bUseRenderCache;
+
+	// Directory of the render cache, which can be shared by a team (empty: Saved/PDFRenderCache of the project)
+	UPROPERTY(config, EditAnywhere, Category = "Render Cache", meta = (EditCondition = "bUseRenderCache", ConfigRestartRequired = true))
+	FString RenderCacheDirectory;
+
+	// Size of the render cache in megabytes, beyond which the least recently used documents are removed
+	UPROPERTY(config, EditAnywhere, Category = "Render Cache", meta = (EditCondition = "bUseRenderCache", ClampMin = 1, UIMin = 1, ConfigRestartRequired = true))
+	int RenderCacheMegabytes;
+
+	// Directory under which each conversion writes its page files to a working directory of its own (empty: Saved/ConvertTemp of the project)
+	UPROPERTY(config, EditAnywhere, Category = "Workspace", meta = (ConfigRestartRequired = true))
+	FString WorkspaceDirectory;
+
+	// Put the working directories in memory instead (/dev/shm on Linux, ignored where there is no RAM-backed file system)
+	UPROPERTY(config, EditAnywhere, Category = "Workspace", meta = (ConfigRestartRequired = true))
+	bool bUseRamWorkspace;
+
+	// Conversions started by the Convert PDF to PDFAsset node that run at the same time, the rest wait in the order of their priority (0: half of the cores)
+	UPROPERTY(config, EditAnywhere, Category = "Scheduler", meta = (ClampMin = 0, UIMin = 0, ConfigRestartRequired = true))
+	int MaxConcurrentConversions;
+
+	// Megabytes of page pixels turned into runtime textures in one frame, at least one page is uploaded in each frame
+	UPROPERTY(config, EditAnywhere, Category = "Scheduler", meta = (ClampMin = 1, UIMin = 1, ConfigRestartRequired = true))
+	int UploadMegabytesPerFrame;
+
+	// Block compression of the page textures created by editor imports, encoded in parallel while the pages are imported
+	UPROPERTY(config, EditAnywhere, Category = "Compression")
+	EPDFPageCompression ImportCompression;
+
+	// Encode the page textures of runtime conversions to BC1 on the converting threads, which uses 1/8 of the GPU memory of BGRA8
+	UPROPERTY(config, EditAnywhere, Category = "Compression", meta = (ConfigRestartRequired = true))
+	bool bCompressRuntimePages;
+
+	// Give the page textures a full mip chain, so that pages shown small are filtered instead of aliasing and imported pages can stream their mips
+	UPROPERTY(config, EditAnywhere, Category = "Mips", meta = (ConfigRestartRequired = true))
+	bool bGeneratePageMips;
+
+	// Import the pages as streaming virtual textures, so that only the tiles that are sampled become resident
+	// Lets pages rendered at a high DPI exceed the maximum texture size, and needs virtual texture support enabled in the project settings
+	UPROPERTY(config, EditAnywhere, Category = "Virtual Textures", meta = (ConfigRestartRequired = true))
+	bool bImportAsVirtualTextures;
+
+public:
+	UPDFImporterSettings() : NumRenderingThreads(0), MaxBitmapMegabytes(0), bUseRenderCache(true), RenderCacheMegabytes(2048), bUseRamWorkspace(false), MaxConcurrentConversions(0), UploadMegabytesPerFrame(32), ImportCompression(EPDFPageCompression::None), bCompressRuntimePages(false), bGeneratePageMips(true), bImportAsVirtualTextures(false) {}
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectMacros.h"
+#include "PDFTextIndex.generated.h"
+
+USTRUCT(BlueprintType)
+struct FPDFTextMatch
+{
+	GENERATED_BODY()
+
+public:
+	FPDFTextMatch() : Page(0), Box(ForceInit) {}
+
+	// Page that contains the match, numbered the same as UPDF::GetPageTexture
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "TextMatch")
+	int Page;
+
+	// Bounds of the matched words in pixels of the page texture, from the top left
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "TextMatch")
+	FBox2D Box;
+};
+
+// Searchable text of the pages, stored in UPDF
+// Words are kept in reading order with quantized boxes, and looked up through a sorted term list
+// and a trigram index of the terms, so that a query never scans the text of the document
+class PDFIMPORTER_API FPDFTextIndex
+{
+public:
+	// Word extracted from a page, with its box in points from the top left of the page
+	struct FWord
+	{
+		int Page;
+		FString Text;
+		FBox2D Box;
+	};
+
+private:
+	// Occurrences of the words in reading order
+	// Boxes are quantized to 1/4 point as MinX, MinY, MaxX, MaxY
+	TArray<int32> OccurrencePages;
+	TArray<int32> OccurrenceTerms;
+	TArray<uint16> OccurrenceBoxes;
+
+	// Lowercase terms in sorted order, and the occurrences of each term
+	TArray<FString> Terms;
+	TArray<int32> TermOffsets;
+	TArray<int32> TermOccurrences;
+
+	// Sorted trigrams of the terms, and the terms that contain each trigram
+	TArray<uint64> Trigrams;
+	TArray<int32> TrigramOffsets;
+	TArray<int32> TrigramTerms;
+
+public:
+	// Build the index from the words of all pages in reading order
+	void Build(const TArray<FWord>& Words);
+
+	// Find the words or phrases that contain the query, ignoring case
+	// Each word of the query matches the words of the text that contain it (or start with it when shorter than 3 letters)
+	// and the words of a phrase must follow each other on the same page
+	// Boxes are scaled by PointsToPixels
+	TArray<FPDFTextMatch> Find(const FString& Query, float PointsToPixels) const;
+
+	bool IsEmpty() const { return Terms.Num() == 0; }
+
+	void Empty();
+
+	friend PDFIMPORTER_API FArchive& operator<<(FArchive& Ar, FPDFTextIndex& Index);
+
+private:
+	// Get the sorted indices of the terms matching a lowercase word of the query
+	TArray<int32> FindTerms(const FString& Word) const;
+
+	// Pack three lowercase characters into a trigram key
+	static uint64 MakeTrigram(const TCHAR* Chars);
+
+	// Get the box of an occurrence in points
+	FBox2D GetOccurrenceBox(int32 Occurrence) const;
+};
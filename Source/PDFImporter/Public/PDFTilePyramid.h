@@ -0,0 +1,118 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PDF.h"
+#include "IPDFRasterizer.h"
+#include "PDFConversionToken.h"
+#include "UObject/GCObject.h"
+#include "Containers/Queue.h"
+#include "Async/Future.h"
+
+// Pages of PDF rendered on demand as fixed size tiles at several resolutions, for viewing pages at any zoom
+// Each level doubles the resolution of the previous one, tiles are rendered in the background the first time
+// they are requested, and only the tiles used recently are kept as textures
+class PDFIMPORTER_API FPDFTilePyramid : public FGCObject
+{
+public:
+	// Width and height of a tile in pixels
+	static const int TileSize = 512;
+
+	// Part of a texture that shows a tile
+	// When the tile is not rendered yet, this is the part of a coarser tile that covers the same area
+	struct FTileView
+	{
+		class UTexture2D* Texture;
+		FBox2D UV;
+
+		FTileView() : Texture(nullptr), UV(FVector2D(0.0f, 0.0f), FVector2D(1.0f, 1.0f)) {}
+	};
+
+private:
+	struct FTile
+	{
+		class UTexture2D* Texture;
+		uint64 LastUsedFrame;
+		bool bIsPending;
+
+		FTile() : Texture(nullptr), LastUsedFrame(0), bIsPending(false) {}
+	};
+
+	// Tiles finished by the render tasks, shared with them
+	struct FRenderedTiles
+	{
+		TQueue<TPair<uint64, FPDFPageBitmap>, EQueueMode::Mpsc> Queue;
+	};
+
+	// Creates the textures of the tiles
+	TSharedPtr<class FGhostscriptCore> GhostscriptCore;
+
+	FString InputPath;
+	EPDFRasterizerBackend Backend;
+	int BaseDpi;
+	int NumLevels;
+	int MaxResidentTiles;
+
+	// Document kept open by the rasterizer for the lifetime of the pyramid, shared with the render tasks
+	TSharedPtr<IPDFTileRenderer, ESPMode::ThreadSafe> TileRenderer;
+
+	// Canceled on destruction so that the tiles being rendered stop early
+	FPDFConversionToken Token;
+
+	// Page boxes used to lay out the tiles of each level
+	FPDFDocumentInfo DocumentInfo;
+
+	// Tiles that are rendered or being rendered, keyed by MakeTileKey
+	TMap<uint64, FTile> Tiles;
+
+	TSharedRef<FRenderedTiles, ESPMode::ThreadSafe> RenderedTiles;
+	int NumPendingTiles;
+
+	// Render tasks that may still be running, waited for on destruction
+	TArray<TFuture<void>> RenderTasks;
+	uint64 CurrentFrame;
+
+public:
+	// Create the pyramid of the PDF file, or nullptr if its pages cannot be read
+	// Level 0 is rendered at BaseDpi and level N at BaseDpi * 2^N
+	static TSharedPtr<FPDFTilePyramid> Create(const FString& InputPath, EPDFRasterizerBackend Backend = EPDFRasterizerBackend::Ghostscript, int BaseDpi = 36, int NumLevels = 6, int MaxResidentTiles = 128);
+
+	// Destructor
+	virtual ~FPDFTilePyramid();
+
+	int GetNumPages() const { return DocumentInfo.NumPages; }
+
+	int GetNumLevels() const { return NumLevels; }
+
+	int GetLevelDpi(int Level) const { return BaseDpi << Level; }
+
+	// Get the size of a page in pixels at the level
+	FIntPoint GetPageSize(int Page, int Level) const;
+
+	// Get the lowest level whose page is at least DisplayedWidth pixels wide
+	int ChooseLevel(int Page, float DisplayedWidth) const;
+
+	// Get the texture to draw for a tile, and request the tile if it is not rendered yet
+	// Returns false when neither the tile nor any coarser tile covering it is available
+	bool GetTile(int Page, int Level, int TileX, int TileY, FTileView& OutView);
+
+	// Create the textures of the tiles rendered since the last call and release the tiles not used recently
+	// Call once per frame on the game thread, before GetTile
+	void Update();
+
+	// FGCObject interface
+	virtual void AddReferencedObjects(FReferenceCollector& Collector) override;
+	// End of FGCObject interface
+
+private:
+	// Constructor
+	FPDFTilePyramid(TSharedPtr<class FGhostscriptCore> InGhostscriptCore, const FString& InInputPath, EPDFRasterizerBackend InBackend, int InBaseDpi, int InNumLevels, int InMaxResidentTiles);
+
+	// Pack the position of a tile into a key
+	static uint64 MakeTileKey(int Page, int Level, int TileX, int TileY);
+
+	// Start rendering a tile in the background unless too many tiles are already being rendered
+	void RequestTile(uint64 Key, int Page, int Level, int TileX, int TileY);
+
+	// Release the least recently used tiles until no more than MaxResidentTiles remain
+	void Trim();
+};
@@ -2,11 +2,15 @@
 #include "GhostscriptCore.h"
 #include "PDF.h"
 #include "PDFImportOptions.h"
+#include "PDFConversionToken.h"
+#include "Misc/ScopedSlowTask.h"
 #include "HAL/FileManager.h"
+#include "Misc/SecureHash.h"
 #include "EditorFramework/AssetImportData.h"
 #include "Framework/Application/SlateApplication.h"
 #include "Editor/MainFrame/Public/Interfaces/IMainFrameModule.h"
 #include "ObjectTools.h"
+#include "FileHelpers.h"
 #include "Editor.h"
 
 #define LOCTEXT_NAMESPACE "PDFFactory"
@@ -49,23 +53,76 @@ UObject* UPDFFactory::FactoryCreateFile(
 {
 	TSharedPtr<SPDFImportOptions> Options;
 	UPDFImportOptions* Result = NewObject<UPDFImportOptions>();
+
+	// y[W͈͂mFł悤ɁAϊ̑OɃy[WƃTCY𒲂ׂ
+	FPDFDocumentInfo DocumentInfo;
+	if (GhostscriptCore->ProbePdf(Filename, DocumentInfo))
+	{
+		Result->NumPages = DocumentInfo.NumPages;
+		Result->LastPage = DocumentInfo.NumPages;
+		if (DocumentInfo.Pages.Num() > 0)
+		{
+			const FPDFPageInfo& FirstPageInfo = DocumentInfo.Pages[0];
+			const FVector2D CropSize = FirstPageInfo.CropBox.GetSize();
+			Result->PageSize = (FirstPageInfo.Rotation % 180 == 0) ? CropSize : FVector2D(CropSize.Y, CropSize.X);
+		}
+	}
+
 	ShowImportOptionWindow(Options, Filename, Result);
 
 	if (Options->ShouldImport())
 	{
+		// i_CAOɕ\ALZ{^ŕϊ𒆒f
+		FScopedSlowTask SlowTask(1.0f, LOCTEXT("ImportingPDF", "Importing PDF..."));
+		SlowTask.MakeDialog(true);
+
+		FPDFConversionToken Token;
+		float ReportedProgress = 0.0f;
+		Token.SetProgressHandler([&SlowTask, &ReportedProgress](FPDFConversionToken& InToken)
+		{
+			if (SlowTask.ShouldCancel())
+			{
+				InToken.Cancel();
+			}
+
+			const int NumPagesTotal = InToken.GetNumPagesTotal();
+			const float Progress = NumPagesTotal > 0 ? FMath::Min((float)InToken.GetNumPagesDone() / NumPagesTotal, 1.0f) : 0.0f;
+			SlowTask.EnterProgressFrame(Progress - ReportedProgress, FText::Format(
+				LOCTEXT("ImportingPDFProgress", "Importing PDF... {0} / {1} pages ({2})"),
+				FText::AsNumber(InToken.GetNumPagesDone()), FText::AsNumber(NumPagesTotal), FText::AsMemory(InToken.GetBytesProcessed())
+			));
+			ReportedProgress = Progress;
+		});
+
+		// ăC|[gł͕`挋ʂςȂy[W̃eNX`g
+		const FPDFReusablePages* ReusablePages = (ReimportPages.Pages.Num() > 0) ? &ReimportPages : nullptr;
+		UPDF* LoadedPDF = GhostscriptCore->ConvertPdfToPdfAsset(Filename, Result->Dpi, Result->FirstPage, Result->LastPage, Result->RenderMode, Result->Backend, true, nullptr, &Token, 0, ReusablePages);
+		if (Token.IsCanceled())
+		{
+			bOutOperationCanceled = true;
+			return nullptr;
+		}
+
 		UPDF* NewPDF = CastChecked<UPDF>(StaticConstructObject_Internal(InClass, InParent, InName, Flags));
-		UPDF* LoadedPDF = GhostscriptCore->ConvertPdfToPdfAsset(Filename, Result->Dpi, Result->FirstPage, Result->LastPage, true);
 
 		if (LoadedPDF != nullptr)
 		{
 			NewPDF->PageRange = LoadedPDF->PageRange;
 			NewPDF->Dpi = LoadedPDF->Dpi;
 			NewPDF->Pages = LoadedPDF->Pages;
+			NewPDF->PageSizes = LoadedPDF->PageSizes;
+			NewPDF->PageFingerprints = LoadedPDF->PageFingerprints;
+
+			// ł悤ɃeLXg𒊏o
+			if (Result->bExtractText)
+			{
+				GhostscriptCore->ExtractText(Filename, Result->FirstPage, Result->LastPage, NewPDF->TextIndex, &Token);
+			}
 
 			NewPDF->Filename = Filename;
 			NewPDF->TimeStamp = IFileManager::Get().GetTimeStamp(*Filename);
 			NewPDF->AssetImportData = NewObject<UAssetImportData>();
-			NewPDF->AssetImportData->SourceData.Insert({ NewPDF->Filename, NewPDF->TimeStamp });
+			NewPDF->AssetImportData->SourceData.Insert({ NewPDF->Filename, NewPDF->TimeStamp, FMD5Hash::HashFile(*Filename) });
 		}
 
 		return NewPDF;
@@ -116,18 +173,59 @@ EReimportResult::Type UPDFFactory::Reimport(UObject* Obj)
 		return EReimportResult::Failed;
 	}
 
-	// Ây[W̃eNX`AZbg폜
-	if(!DeletePageTextures(PDF))
+	// ςœeȂ牽ȂinbV̓t@CǂŌvZj
+	// C|[g̃nbV̓C|[g̃t@C̏ƂċL^Ă
+	const FMD5Hash ContentHash = FMD5Hash::HashFile(*Filename);
+	if (ContentHash.IsValid() && ContentHash == PDF->AssetImportData->SourceData.SourceFiles[0].FileHash && PDF->Pages.Num() > 0)
 	{
-		FString DirectoryPath = FPaths::Combine(FGhostscriptCore::PagesDirectoryPath, FPaths::GetBaseFilename(PDF->Filename));
-		UE_LOG(PDFImporter, Warning, TEXT("Failed to delete texture assets on all pages, so you need to delete them manually. : %s"), *DirectoryPath);
+		UE_LOG(PDFImporter, Log, TEXT("Skipped reimporting %s because its contents are unchanged"), *Filename);
+		return EReimportResult::Succeeded;
 	}
 
-	EReimportResult::Type Result = EReimportResult::Failed;
-	if (UFactory::StaticImportObject(
+	// ύX̖y[W̃eNX`g񂹂悤ɁAÕy[Wn
+	const TArray<UTexture2D*> OldPages = PDF->Pages;
+	ReimportPages.Pages = PDF->Pages;
+	ReimportPages.Fingerprints = PDF->PageFingerprints;
+
+	UObject* ImportedObject = UFactory::StaticImportObject(
 		PDF->GetClass(), PDF->GetOuter(),
-		*PDF->GetName(), RF_Public | RF_Standalone, *Filename, NULL, this))
+		*PDF->GetName(), RF_Public | RF_Standalone, *Filename, NULL, this);
+	ReimportPages = FPDFReusablePages();
+
+	UPDF* ReimportedPDF = Cast<UPDF>(ImportedObject);
+	if (ReimportedPDF != nullptr)
 	{
+		// g񂳂ȂÂy[W̃eNX`AZbg폜
+		TArray<UTexture2D*> UnusedPages;
+		for (UTexture2D* OldPage : OldPages)
+		{
+			if (OldPage != nullptr && !ReimportedPDF->Pages.Contains(OldPage))
+			{
+				UnusedPages.Add(OldPage);
+			}
+		}
+		UE_LOG(PDFImporter, Log, TEXT("Reimported %s : kept %d pages, replaced %d pages"), *Filename, OldPages.Num() - UnusedPages.Num(), UnusedPages.Num());
+
+		if (!DeleteTextures(UnusedPages))
+		{
+			FString DirectoryPath = FPaths::Combine(FGhostscriptCore::PagesDirectoryPath, FPaths::GetBaseFilename(ReimportedPDF->Filename));
+			UE_LOG(PDFImporter, Warning, TEXT("Failed to delete texture assets on all pages, so you need to delete them manually. : %s"), *DirectoryPath);
+		}
+
+		// ȑÕo[Wł͑Sy[W1̃pbP[WɓĂ̂ŁAÂy[W폜pbP[W͍Ō1񂾂ۑ
+		TArray<UPackage*> KeptPackages;
+		for (UTexture2D* Page : ReimportedPDF->Pages)
+		{
+			if (Page != nullptr && OldPages.Contains(Page) && Page->GetOutermost()->IsDirty())
+			{
+				KeptPackages.AddUnique(Page->GetOutermost());
+			}
+		}
+		if (KeptPackages.Num() > 0)
+		{
+			UEditorLoadingAndSavingUtils::SavePackages(KeptPackages, true);
+		}
+
 		if (PDF->GetOuter())
 		{
 			PDF->GetOuter()->MarkPackageDirty();
@@ -190,10 +288,15 @@ void UPDFFactory::ShowImportOptionWindow(TSharedPtr<SPDFImportOptions>& Options,
 
 bool UPDFFactory::DeletePageTextures(UPDF* PdfToDelete)
 {
-	if (PdfToDelete->Pages.Num() != 0)
+	return DeleteTextures(PdfToDelete->Pages);
+}
+
+bool UPDFFactory::DeleteTextures(const TArray<UTexture2D*>& Textures)
+{
+	if (Textures.Num() != 0)
 	{
 		TArray<UObject*> AssetsToDelete;
-		for (auto Page : PdfToDelete->Pages)
+		for (auto Page : Textures)
 		{
 			AssetsToDelete.Add(Cast<UObject>(Page));
 		}
@@ -73,6 +73,16 @@ void SPDFImportOptions::Construct(const FArguments& InArgs)
 			[
 				DetailsView->AsShared()
 			]
+		// ページ範囲の誤り
+		+ SVerticalBox::Slot()
+			.AutoHeight()
+			.Padding(2)
+			[
+				SNew(STextBlock)
+				.ColorAndOpacity(FLinearColor::Red)
+				.Text(this, &SPDFImportOptions::GetValidationError)
+				.Visibility_Lambda([this]() { return CanImport() ? EVisibility::Collapsed : EVisibility::Visible; })
+			]
 		// インポートとキャンセルのボタン
 		+ SVerticalBox::Slot()
 			.AutoHeight()
@@ -86,6 +96,7 @@ void SPDFImportOptions::Construct(const FArguments& InArgs)
 						SNew(SButton)
 						.HAlign(HAlign_Center)
 						.Text(LOCTEXT("PDFImportOptions_Import", "Import"))
+						.IsEnabled(this, &SPDFImportOptions::CanImport)
 						.OnClicked(this, &SPDFImportOptions::OnImport)
 					]
 
@@ -118,6 +129,27 @@ FReply SPDFImportOptions::OnImport()
 	return FReply::Handled();
 }
 
+FText SPDFImportOptions::GetValidationError() const
+{
+	if (!ImportOptions->SpecifyPageRange)
+	{
+		return FText::GetEmpty();
+	}
+
+	if (ImportOptions->FirstPage > ImportOptions->LastPage)
+	{
+		return LOCTEXT("PDFImportOptions_InvalidRange", "FirstPage must not be greater than LastPage.");
+	}
+
+	// ページ数が分かっている場合だけ範囲を確認する
+	if (ImportOptions->NumPages > 0 && ImportOptions->LastPage > ImportOptions->NumPages)
+	{
+		return FText::Format(LOCTEXT("PDFImportOptions_OutOfRange", "LastPage must not be greater than the number of pages ({0})."), FText::AsNumber(ImportOptions->NumPages));
+	}
+
+	return FText::GetEmpty();
+}
+
 FReply SPDFImportOptions::OnCancel()
 {
 	bShouldImport = false;
@@ -3,6 +3,7 @@
 #include "CoreMinimal.h"
 #include "Factories/Factory.h"
 #include "EditorReimportHandler.h"
+#include "GhostscriptCore.h"
 #include "PDFFactory.generated.h"
 
 UCLASS()
@@ -13,6 +14,9 @@ class PDFIMPORTERED_API UPDFFactory : public UFactory, public FReimportHandler
 private:
 	TSharedPtr<class FGhostscriptCore> GhostscriptCore;
 
+	// Pages of the asset being reimported, whose textures are kept for the pages that render the same
+	FPDFReusablePages ReimportPages;
+
 public:
 	// UFactory interface
 	virtual bool DoesSupportClass(UClass* Class) override;
@@ -44,4 +48,7 @@ private:
 
 	// Delete all corresponding texture assets of PDF asset
 	bool DeletePageTextures(class UPDF* PdfToDelete);
+
+	// Delete the page texture assets
+	bool DeleteTextures(const TArray<class UTexture2D*>& Textures);
 };
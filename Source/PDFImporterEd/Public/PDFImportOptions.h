@@ -6,6 +6,7 @@
 #include "UObject/NoExportTypes.h"
 #include "Widgets/SWindow.h"
 #include "Widgets/SCompoundWidget.h"
+#include "PDF.h"
 #include "PDFImportOptions.generated.h"
 
 UCLASS()
@@ -14,6 +15,14 @@ class PDFIMPORTERED_API UPDFImportOptions : public UObject
 	GENERATED_BODY()
 	
 public:
+	// Number of pages read from the file before importing (0: unknown)
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Document")
+	int NumPages;
+
+	// Size of the first page in points
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Document")
+	FVector2D PageSize;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PageRange")
 	bool SpecifyPageRange;
 
@@ -26,8 +35,18 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dpi")
 	int Dpi;
 
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Render")
+	EPDFRenderMode RenderMode;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Render", meta = (EditCondition = "RenderMode == EPDFRenderMode::InMemory"))
+	EPDFRasterizerBackend Backend;
+
+	// Extract the text of the pages so that it can be searched with FindText
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Text")
+	bool bExtractText;
+
 public:
-	UPDFImportOptions() : SpecifyPageRange(false), FirstPage(1), LastPage(1), Dpi(150) {}
+	UPDFImportOptions() : NumPages(0), PageSize(FVector2D::ZeroVector), SpecifyPageRange(false), FirstPage(1), LastPage(1), Dpi(150), RenderMode(EPDFRenderMode::InMemory), Backend(EPDFRasterizerBackend::Ghostscript), bExtractText(false) {}
 };
 
 class SPDFImportOptions : public SCompoundWidget
@@ -61,5 +80,11 @@ public:
 
 	// Import was done
 	bool ShouldImport() const { return bShouldImport; }
+
+private:
+	// Get why the options cannot be imported, or an empty text if they can
+	FText GetValidationError() const;
+
+	bool CanImport() const { return GetValidationError().IsEmpty(); }
 };
 
@@ -74,4 +74,12 @@ public:
 	/** If true, displays a border around the texture. */
 	UPROPERTY(config)
 	bool TextureBorderEnabled;
+
+	/** If true, pages zoomed in beyond their imported resolution are rendered again from the source PDF in tiles. */
+	UPROPERTY(config, EditAnywhere, Category=Zoom)
+	bool RenderTilesWhenZoomed;
+
+	/** The number of page tiles kept in memory for zooming. Each tile takes 1 MB. */
+	UPROPERTY(config, EditAnywhere, Category=Zoom, meta=(ClampMin="16", ClampMax="4096", EditCondition="RenderTilesWhenZoomed"))
+	int32 MaxResidentTiles;
 };
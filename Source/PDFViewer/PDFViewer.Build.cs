@@ -19,7 +19,8 @@ public class PDFViewer : ModuleRules
 			new string[] {
 				"Settings",
 				"UnrealEd",
-                "PropertyEditor"
+                "PropertyEditor",
+                "Renderer"
 			}
 		);
 
@@ -19,6 +19,9 @@
 #include "Widgets/SPDFViewerViewport.h"
 #include "CanvasTypes.h"
 #include "ImageUtils.h"
+#include "PDFTilePyramid.h"
+#include "RendererInterface.h"
+#include "VirtualTexturing.h"
 
 
 /* FPDFViewerViewportClient structors
@@ -72,11 +75,11 @@ void FPDFViewerViewportClient::Draw(FViewport* Viewport, FCanvas* Canvas)
 	UTextureRenderTarget2D* TextureRT2D = Cast<UTextureRenderTarget2D>(Texture);
 	UTextureRenderTargetCube* RTTextureCube = Cast<UTextureRenderTargetCube>(Texture);
 
-	// Fully stream in the texture before drawing it.
+	// Request all mips of the texture, but draw the ones already resident instead of waiting for them
+	// so that the page shows up at once and sharpens as the rest stream in.
 	if (Texture2D)
 	{
 		Texture2D->SetForceMipLevelsToBeResident(30.0f);
-		Texture2D->WaitForStreaming();
 	}
 
 	PDFViewerPtr.Pin()->PopulateQuickInfo();
@@ -139,8 +142,23 @@ void FPDFViewerViewportClient::Draw(FViewport* Viewport, FCanvas* Canvas)
 		FCanvasTileItem TileItem( FVector2D( XPos, YPos ), Texture->Resource, FVector2D( Width, Height ), FLinearColor(Exposure, Exposure, Exposure) );
 		TileItem.BlendMode = PDFViewerPtr.Pin()->GetColourChannelBlendMode();
 		//TileItem.BatchedElementParameters = BatchedElementParameters;
+
+		// Virtual textured pages can only be sampled by the preview shader, and only the tiles in view are loaded
+		if (Texture2D != nullptr && Texture2D->IsCurrentlyVirtualTextured())
+		{
+			RequestVirtualTextureTiles(Texture2D, FVector2D(XPos, YPos), FVector2D(Width, Height), ViewportSize);
+			TileItem.BatchedElementParameters = new FBatchedElementTexture2DPreviewParameters(-1.0f, 0.0f, false, false, Texture2D->IsVirtualTexturedWithSinglePhysicalSpace(), true, false);
+		}
+
 		Canvas->DrawItem( TileItem );
 
+		// Draw sharper tiles of the source PDF over the page when it is zoomed in beyond its imported resolution
+		TSharedPtr<FPDFTilePyramid> TilePyramid = PDFViewerPtr.Pin()->GetTilePyramid();
+		if (TilePyramid.IsValid() && Texture2D != nullptr)
+		{
+			DrawPageTiles(*TilePyramid, PDFViewerPtr.Pin()->GetCurrentPage(), Texture2D->GetSizeX(), FVector2D(XPos, YPos), FVector2D(Width, Height), ViewportSize, TileItem.BlendMode, FLinearColor(Exposure, Exposure, Exposure), Canvas);
+		}
+
 		// Draw a white border around the texture to show its extents
 		if (Settings.TextureBorderEnabled)
 		{
@@ -152,6 +170,71 @@ void FPDFViewerViewportClient::Draw(FViewport* Viewport, FCanvas* Canvas)
 }
 
 
+void FPDFViewerViewportClient::DrawPageTiles(FPDFTilePyramid& TilePyramid, int32 Page, int32 TextureWidth, const FVector2D& Position, const FVector2D& Size, const FVector2D& ViewportSize, ESimpleElementBlendMode BlendMode, const FLinearColor& Color, FCanvas* Canvas)
+{
+	TilePyramid.Update();
+
+	// Only render tiles when they are sharper than the imported page
+	const int32 Level = TilePyramid.ChooseLevel(Page, Size.X);
+	const FIntPoint LevelSize = TilePyramid.GetPageSize(Page, Level);
+	if (LevelSize.X <= TextureWidth || LevelSize.X <= 0)
+	{
+		return;
+	}
+
+	// Find the tiles of the level that intersect the viewport
+	const float Scale = Size.X / LevelSize.X;
+	const int32 TileSize = FPDFTilePyramid::TileSize;
+	const int32 NumTilesX = FMath::DivideAndRoundUp(LevelSize.X, TileSize);
+	const int32 NumTilesY = FMath::DivideAndRoundUp(LevelSize.Y, TileSize);
+	const int32 MinTileX = FMath::Clamp(FMath::FloorToInt(-Position.X / Scale / TileSize), 0, NumTilesX - 1);
+	const int32 MinTileY = FMath::Clamp(FMath::FloorToInt(-Position.Y / Scale / TileSize), 0, NumTilesY - 1);
+	const int32 MaxTileX = FMath::Clamp(FMath::FloorToInt((ViewportSize.X - Position.X) / Scale / TileSize), 0, NumTilesX - 1);
+	const int32 MaxTileY = FMath::Clamp(FMath::FloorToInt((ViewportSize.Y - Position.Y) / Scale / TileSize), 0, NumTilesY - 1);
+
+	for (int32 TileY = MinTileY; TileY <= MaxTileY; ++TileY)
+	{
+		for (int32 TileX = MinTileX; TileX <= MaxTileX; ++TileX)
+		{
+			FPDFTilePyramid::FTileView TileView;
+			if (!TilePyramid.GetTile(Page, Level, TileX, TileY, TileView) || TileView.Texture->Resource == nullptr)
+			{
+				continue;
+			}
+
+			const FVector2D TileMin(TileX * TileSize, TileY * TileSize);
+			const FVector2D TileMax(FMath::Min((TileX + 1) * TileSize, LevelSize.X), FMath::Min((TileY + 1) * TileSize, LevelSize.Y));
+			FCanvasTileItem TileItem( Position + TileMin * Scale, TileView.Texture->Resource, (TileMax - TileMin) * Scale, TileView.UV.Min, TileView.UV.Max, Color );
+			TileItem.BlendMode = BlendMode;
+			Canvas->DrawItem( TileItem );
+		}
+	}
+}
+
+
+void FPDFViewerViewportClient::RequestVirtualTextureTiles(UTexture2D* Texture, const FVector2D& Position, const FVector2D& Size, const FVector2D& ViewportSize)
+{
+	FVirtualTexture2DResource* VTResource = static_cast<FVirtualTexture2DResource*>(Texture->Resource);
+	const FVector2D ViewportPosition = -Position;
+	const ERHIFeatureLevel::Type FeatureLevel = GMaxRHIFeatureLevel;
+
+	ENQUEUE_RENDER_COMMAND(MakePDFPageTilesResident)(
+		[VTResource, Size, ViewportPosition, ViewportSize, FeatureLevel](FRHICommandListImmediate& RHICmdList)
+	{
+		// The allocated virtual texture must be acquired on the render thread
+		IAllocatedVirtualTexture* AllocatedVT = VTResource->AcquireAllocatedVT();
+		if (AllocatedVT == nullptr)
+		{
+			return;
+		}
+
+		IRendererModule& RendererModule = GetRendererModule();
+		RendererModule.RequestVirtualTextureTilesForRegion(AllocatedVT, Size, ViewportPosition, ViewportSize, FVector2D::ZeroVector, FVector2D::UnitVector, -1);
+		RendererModule.LoadPendingVirtualTextureTiles(RHICmdList, FeatureLevel);
+	});
+}
+
+
 bool FPDFViewerViewportClient::InputKey(FViewport* Viewport, int32 ControllerId, FKey Key, EInputEvent Event, float AmountDepressed, bool Gamepad)
 {
 	if (Key == EKeys::MouseScrollUp)
@@ -6,8 +6,10 @@
 #include "InputCoreTypes.h"
 #include "UObject/GCObject.h"
 #include "UnrealClient.h"
+#include "SceneTypes.h"
 
 class FCanvas;
+class FPDFTilePyramid;
 class IPDFViewerToolkit;
 class SPDFViewerViewport;
 class UTexture2D;
@@ -48,6 +50,12 @@ private:
 	/** Returns the positions of the scrollbars relative to the Texture textures */
 	FVector2D GetViewportScrollBarPositions() const;
 
+	/** Draws the tiles of the source PDF that are visible in the viewport over the page texture */
+	void DrawPageTiles(FPDFTilePyramid& TilePyramid, int32 Page, int32 TextureWidth, const FVector2D& Position, const FVector2D& Size, const FVector2D& ViewportSize, ESimpleElementBlendMode BlendMode, const FLinearColor& Color, FCanvas* Canvas);
+
+	/** Makes the tiles of a virtual textured page that cover the viewport resident before the page is drawn */
+	void RequestVirtualTextureTiles(UTexture2D* Texture, const FVector2D& Position, const FVector2D& Size, const FVector2D& ViewportSize);
+
 	/** Destroy the checkerboard texture if one exists */
 	void DestroyCheckerboardTexture();
 
@@ -14,4 +14,6 @@ UPDFViewerSettings::UPDFViewerSettings( const FObjectInitializer& ObjectInitiali
 	, FitToViewport(true)
 	, TextureBorderColor(FColor::White)
 	, TextureBorderEnabled(true)
+	, RenderTilesWhenZoomed(true)
+	, MaxResidentTiles(128)
 { }
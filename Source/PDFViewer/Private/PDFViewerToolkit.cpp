@@ -38,6 +38,8 @@
 #include "Curves/CurveLinearColorAtlas.h"
 #include "PDFViewerStyle.h"
 #include "PDF.h"
+#include "PDFTilePyramid.h"
+#include "HAL/FileManager.h"
 
 #define LOCTEXT_NAMESPACE "FPDFViewerToolkit"
 
@@ -116,6 +118,13 @@ void FPDFViewerToolkit::InitPDFViewer( const EToolkitMode::Type Mode, const TSha
 	CurrentPage = 1;
 	Texture = PDF->GetPageTexture(CurrentPage);
 
+	// Render the pages again from the source PDF when zooming in, if it is still there
+	const UPDFViewerSettings& Settings = *GetDefault<UPDFViewerSettings>();
+	if (Settings.RenderTilesWhenZoomed && IFileManager::Get().FileExists(*PDF->Filename))
+	{
+		TilePyramid = FPDFTilePyramid::Create(PDF->Filename, EPDFRasterizerBackend::Ghostscript, 36, 6, Settings.MaxResidentTiles);
+	}
+
 	// Support undo/redo
 	Texture->SetFlags(RF_Transactional);
 	GEditor->RegisterForUndo(this);
@@ -308,6 +317,18 @@ void FPDFViewerToolkit::CalculateTextureDimensions( uint32& Width, uint32& Heigh
 }
 
 
+int32 FPDFViewerToolkit::GetCurrentPage( ) const
+{
+	return CurrentPage;
+}
+
+
+TSharedPtr<FPDFTilePyramid> FPDFViewerToolkit::GetTilePyramid( ) const
+{
+	return TilePyramid;
+}
+
+
 ESimpleElementBlendMode FPDFViewerToolkit::GetColourChannelBlendMode( ) const
 {
 	if (Texture && (Texture->CompressionSettings == TC_Grayscale || Texture->CompressionSettings == TC_Alpha)) 
@@ -58,6 +58,8 @@ public:
 	// IPDFViewerToolkit interface
 
 	virtual void CalculateTextureDimensions( uint32& Width, uint32& Height ) const override;
+	virtual int32 GetCurrentPage( ) const override;
+	virtual TSharedPtr<FPDFTilePyramid> GetTilePyramid( ) const override;
 	virtual ESimpleElementBlendMode GetColourChannelBlendMode( ) const override;
 	virtual bool GetFitToViewport( ) const override;
 	virtual int32 GetMipLevel( ) const override;
@@ -230,6 +232,9 @@ private:
 	/** The Texture asset being inspected */
 	UTexture* Texture;
 
+	/** Tiles rendered from the source PDF when zooming in beyond the imported resolution */
+	TSharedPtr<FPDFTilePyramid> TilePyramid;
+
 	/** Style used in pdf viewer **/
 	class TSharedPtr<class FPDFViewerStyle> Style;
 
@@ -7,6 +7,7 @@
 #include "Toolkits/AssetEditorToolkit.h"
 
 class UTexture;
+class FPDFTilePyramid;
 
 /**
  * Interface for texture editor tool kits.
@@ -24,6 +25,12 @@ public:
 	/** Refreshes the quick info panel */
 	virtual void PopulateQuickInfo() = 0;
 
+	/** Returns the number of the page being inspected, starting at 1 */
+	virtual int32 GetCurrentPage() const = 0;
+
+	/** Returns the tiles rendered from the source PDF for zooming in, or nullptr if they are not available */
+	virtual TSharedPtr<FPDFTilePyramid> GetTilePyramid() const = 0;
+
 	/** Calculates the display size of the texture */
 	virtual void CalculateTextureDimensions(uint32& Width, uint32& Height) const = 0;
 